@@ -25,11 +25,14 @@
 #include <WebKit/WKBundlePagePrivate.h>
 
 #include "AAMPJSController.h"
+#include "LazyBinding.h"
 #include "logger.h"
 #include "utils.h"
 #include <fstream>
 #include <string>
 #include <stdlib.h>
+#include <unordered_set>
+#include <vector>
 
 #define AAMP_UNUSED(x) (void) x
 
@@ -45,6 +48,16 @@ namespace AAMPJSController
 
 bool enableAAMP = false;
 
+// Contexts the controller was loaded into, only tracked in lazy mode.
+static std::unordered_set<JSGlobalContextRef> loadedContexts;
+
+static void loadController(JSGlobalContextRef context)
+{
+    aamp_LoadJSController(context);
+    if (LazyBinding::enabled())
+        loadedContexts.insert(context);
+}
+
 void initialize()
 {
     RDKLOG_TRACE("AAMPJSController::initialize()");
@@ -71,7 +84,13 @@ void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
     if (enableAAMP)
     {
         JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(frame);
-        aamp_LoadJSController(context);
+        if (LazyBinding::enabled())
+        {
+            static const std::vector<std::string> globals = LazyBinding::globalsFromEnv("WPE_LAZY_AAMP_GLOBALS", "AAMP");
+            if (LazyBinding::install(context, globals, loadController))
+                return;
+        }
+        loadController(context);
     }
 }
 
@@ -83,6 +102,9 @@ void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef fram
     if (mainFrame == frame && enableAAMP )
     {
         JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(mainFrame);
+        // Page never touched the lazy bindings, nothing to unload.
+        if (LazyBinding::enabled() && loadedContexts.erase(context) == 0)
+            return;
         RDKLOG_INFO("AAMPJSController::didStartProvisionalLoadForFrame(): Unloading JSController");
         aamp_UnloadJSController(context);
     }
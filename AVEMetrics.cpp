@@ -0,0 +1,235 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "AVEMetrics.h"
+#include "Histogram.h"
+#include "logger.h"
+
+#include <glib.h>
+
+#include <cmath>
+#include <ctype.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+
+namespace AVEMetrics
+{
+
+const char* const kLinePatterns[3] = { "HttpRequestEnd", "TuneTime", "---------> Resume" };
+
+// Field names as AVE writes them, lines without them are counted but not measured.
+const char* const kResponseCodeKey = "responseCode";
+const char* const kTotalTimeKey = "totalTime";
+const char* const kBytesKey = "bytes";
+const char* const kTuneTimeKey = "TuneTime";
+const char* const kResumeKey = "Resume";
+
+namespace
+{
+
+// Key of response codes outside 100-599 or not integral, reported as "other".
+const int kOtherStatus = 0;
+
+// Sessions kept besides the current one.
+const size_t kSessionHistory = 4;
+
+struct Session
+{
+    Session(uint64_t id) : id(id), startTime(g_get_monotonic_time()) {}
+
+    uint64_t id;
+    int64_t startTime;
+    Histogram tuneTime;
+    Histogram httpDuration;
+    Histogram httpBytes;
+    std::map<int, uint64_t> httpStatus;
+    Histogram resumeTime;
+    uint64_t resumes { 0 };
+};
+
+struct State
+{
+    std::mutex mutex;
+    uint64_t nextId { 1 };
+    std::deque<Session> sessions;
+};
+
+State& state()
+{
+    static State& state = *new State();
+    return state;
+}
+
+/**
+ * Numeric "name=value" or "name: value" fields of a line, names are case sensitive.
+ * Durations are in milliseconds.
+ */
+class Fields
+{
+public:
+    explicit Fields(const char* line)
+    {
+        const char* p = line;
+        while (*p)
+        {
+            if (!isalpha(static_cast<unsigned char>(*p)))
+            {
+                ++p;
+                continue;
+            }
+
+            const char* nameStart = p;
+            while (isalnum(static_cast<unsigned char>(*p)) || *p == '_')
+                ++p;
+            std::string name(nameStart, p - nameStart);
+
+            const char* q = p;
+            while (*q == ' ')
+                ++q;
+            if (*q != '=' && *q != ':')
+                continue;
+            ++q;
+            while (*q == ' ')
+                ++q;
+
+            char* end = nullptr;
+            double value = strtod(q, &end);
+            if (end == q)
+                continue;
+
+            m_values.emplace(std::move(name), value);
+            p = end;
+        }
+    }
+
+    bool get(const char* name, double& value) const
+    {
+        auto it = m_values.find(name);
+        if (it == m_values.end() || !std::isfinite(it->second))
+            return false;
+        value = it->second;
+        return true;
+    }
+
+private:
+    std::map<std::string, double> m_values;
+};
+
+Session& currentSession(State& s)
+{
+    if (s.sessions.empty())
+        s.sessions.emplace_back(s.nextId++);
+    return s.sessions.back();
+}
+
+} // namespace
+
+void startSession()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.sessions.emplace_back(s.nextId++);
+    while (s.sessions.size() > kSessionHistory + 1)
+        s.sessions.pop_front();
+}
+
+void addLine(LineType type, const char* data)
+{
+    if (!data)
+        return;
+
+    // Parse before taking the lock, AVE logs from several threads.
+    Fields fields(data);
+    double value = 0;
+
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    Session& session = currentSession(s);
+
+    switch (type)
+    {
+        case HttpRequestEnd:
+            if (fields.get(kResponseCodeKey, value))
+            {
+                // Anything that is not an HTTP status shares one bucket.
+                bool valid = value >= 100 && value <= 599 && std::trunc(value) == value;
+                ++session.httpStatus[valid ? static_cast<int>(value) : kOtherStatus];
+            }
+            if (fields.get(kTotalTimeKey, value))
+                session.httpDuration.add(value);
+            if (fields.get(kBytesKey, value))
+                session.httpBytes.add(value);
+            break;
+        case TuneTime:
+            if (fields.get(kTuneTimeKey, value))
+                session.tuneTime.add(value);
+            else
+                RDKLOG_TRACE("No tune time in '%s'", data);
+            break;
+        case Resume:
+            ++session.resumes;
+            if (fields.get(kResumeKey, value))
+                session.resumeTime.add(value);
+            break;
+    }
+}
+
+std::string toJSON()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    std::string json = "{\"sessions\":[";
+    bool first = true;
+    for (const auto& session : s.sessions)
+    {
+        if (!first)
+            json += ',';
+        first = false;
+
+        json += "{\"id\":" + std::to_string(session.id);
+        json += ",\"age\":" + std::to_string((g_get_monotonic_time() - session.startTime) / 1000);
+        json += ",\"tuneTime\":";
+        session.tuneTime.appendJSON(json);
+        json += ",\"httpDuration\":";
+        session.httpDuration.appendJSON(json);
+        json += ",\"httpBytes\":";
+        session.httpBytes.appendJSON(json);
+        json += ",\"httpStatus\":{";
+        bool firstStatus = true;
+        for (const auto& status : session.httpStatus)
+        {
+            if (!firstStatus)
+                json += ',';
+            firstStatus = false;
+            json += "\"" + (status.first == kOtherStatus ? std::string("other") : std::to_string(status.first))
+                + "\":" + std::to_string(status.second);
+        }
+        json += "},\"resumes\":" + std::to_string(session.resumes);
+        json += ",\"resumeTime\":";
+        session.resumeTime.appendJSON(json);
+        json += '}';
+    }
+    json += "]}";
+    return json;
+}
+
+} // namespace AVEMetrics
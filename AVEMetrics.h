@@ -0,0 +1,59 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef AVEMETRICS_H
+#define AVEMETRICS_H
+
+#include <string>
+
+namespace AVEMetrics
+{
+
+/**
+ * Kinds of AVE eMetric lines that are parsed, in the order of the matcher patterns.
+ */
+enum LineType
+{
+    HttpRequestEnd = 0,
+    TuneTime,
+    Resume,
+};
+
+/**
+ * Pattern that identifies each LineType, index is the LineType.
+ */
+extern const char* const kLinePatterns[3];
+
+/**
+ * Starts aggregating into a new session, called when a tune starts.
+ */
+void startSession();
+
+/**
+ * Parses an eMetric line of the given type into the current session. Thread safe.
+ */
+void addLine(LineType type, const char* data);
+
+/**
+ * @return JSON with per-session histograms, oldest session first.
+ */
+std::string toJSON();
+
+};
+
+#endif // AVEMETRICS_H
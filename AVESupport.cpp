@@ -31,11 +31,19 @@
 
 #include <dlfcn.h>
 
+#include "AVEMetrics.h"
 #include "AVESupport.h"
+#include "LazyBinding.h"
+#include "MemoryPressurePolicy.h"
+#include "MultiPatternMatcher.h"
 #include "logger.h"
 #include "utils.h"
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include <glib.h>
 #include <kernel/Callbacks.h>
@@ -208,6 +216,168 @@ bool initDS()
     return s_wk.m_DSInitialized;
 }
 
+// AVE metric lines the client cares about when not all logs are forwarded.
+static const MultiPatternMatcher& metricLineMatcher()
+{
+    static const MultiPatternMatcher matcher(std::vector<std::string>(std::begin(AVEMetrics::kLinePatterns), std::end(AVEMetrics::kLinePatterns)));
+    return matcher;
+}
+
+/**
+ * Lines waiting to be posted to the client. Written from AVE threads,
+ * posted from the main thread.
+ * By default every line is posted right away as its own "onAVELog" message.
+ * With WPE_AVE_LOG_BATCH_SIZE > 1 lines are posted as an array of
+ * [prefix, level, data] entries in one "onAVELogBatch" message, once the
+ * batch is full or WPE_AVE_LOG_FLUSH_MS (250 by default) after its first
+ * line, so metric lines may reach the client that much later.
+ */
+class AVELogForwarder
+{
+public:
+    static AVELogForwarder& singleton()
+    {
+        static AVELogForwarder& forwarder = *new AVELogForwarder();
+        return forwarder;
+    }
+
+    void push(const char* prefix, AVELogLevel level, const char* data)
+    {
+        bool flushNow = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Line& line = m_ring[(m_head + m_count) % m_ring.size()];
+            if (m_count == m_ring.size())
+            {
+                // Full, overwrite the oldest line.
+                m_head = (m_head + 1) % m_ring.size();
+                ++m_dropped;
+            }
+            else
+            {
+                ++m_count;
+            }
+            line.prefix = prefix ?: "";
+            line.level = level;
+            line.data = data ?: "";
+
+            if (m_count >= m_batchSize)
+                flushNow = !m_flushPending;
+            else if (!m_timerPending && !m_flushPending)
+            {
+                m_timerPending = true;
+                g_timeout_add(m_intervalMs, [](gpointer) -> gboolean {
+                    AVELogForwarder& self = AVELogForwarder::singleton();
+                    {
+                        std::lock_guard<std::mutex> lock(self.m_mutex);
+                        self.m_timerPending = false;
+                    }
+                    self.flush();
+                    return G_SOURCE_REMOVE;
+                }, nullptr);
+            }
+            if (flushNow)
+                m_flushPending = true;
+        }
+
+        // Runs right away when called on the main thread.
+        if (flushNow)
+        {
+            g_main_context_invoke(nullptr, [](gpointer) -> gboolean {
+                AVELogForwarder::singleton().flush();
+                return G_SOURCE_REMOVE;
+            }, nullptr);
+        }
+    }
+
+    bool batching() const { return m_batchSize > 1; }
+
+private:
+    struct Line
+    {
+        std::string prefix;
+        AVELogLevel level;
+        std::string data;
+    };
+
+    AVELogForwarder()
+        : m_head(0)
+        , m_count(0)
+        , m_dropped(0)
+        , m_timerPending(false)
+        , m_flushPending(false)
+    {
+        const char* s = getenv("WPE_AVE_LOG_BATCH_SIZE");
+        m_batchSize = s ? std::max(atoi(s), 1) : 1;
+        s = getenv("WPE_AVE_LOG_FLUSH_MS");
+        m_intervalMs = s ? std::max(atoi(s), 1) : 250;
+        m_ring.resize(std::max<size_t>(m_batchSize * 8, 256));
+    }
+
+    void flush()
+    {
+        std::vector<Line> lines;
+        size_t dropped;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_flushPending = false;
+            lines.reserve(m_count);
+            for (; m_count; --m_count)
+            {
+                lines.push_back(std::move(m_ring[m_head]));
+                m_head = (m_head + 1) % m_ring.size();
+            }
+            dropped = m_dropped;
+            m_dropped = 0;
+        }
+
+        if (dropped)
+            RDKLOG_WARNING("Dropped %zu AVE log lines", dropped);
+
+        if (lines.empty() || !s_wk.m_client)
+            return;
+
+        std::vector<WKRetainPtr<WKArrayRef>> entries;
+        entries.reserve(lines.size());
+        for (const auto& line : lines)
+        {
+            WKRetainPtr<WKStringRef> prefixRef = adoptWK(WKStringCreateWithUTF8CString(line.prefix.c_str()));
+            WKRetainPtr<WKUInt64Ref> levelRef = adoptWK(WKUInt64Create(line.level));
+            WKRetainPtr<WKStringRef> dataRef = adoptWK(WKStringCreateWithUTF8CString(line.data.c_str()));
+
+            WKTypeRef params[] = {prefixRef.get(), levelRef.get(), dataRef.get()};
+            entries.push_back(adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0]))));
+        }
+
+        if (!batching())
+        {
+            WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onAVELog"));
+            for (const auto& entry : entries)
+                WKBundlePagePostMessage(s_wk.m_client, nameRef.get(), entry.get());
+            return;
+        }
+
+        std::vector<WKTypeRef> items;
+        items.reserve(entries.size());
+        for (const auto& entry : entries)
+            items.push_back(entry.get());
+        WKRetainPtr<WKArrayRef> batchRef = adoptWK(WKArrayCreate(items.data(), items.size()));
+
+        WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onAVELogBatch"));
+        WKBundlePagePostMessage(s_wk.m_client, nameRef.get(), batchRef.get());
+    }
+
+    std::mutex m_mutex;
+    std::vector<Line> m_ring;
+    size_t m_head;
+    size_t m_count;
+    size_t m_dropped;
+    size_t m_batchSize;
+    guint m_intervalMs;
+    bool m_timerPending;
+    bool m_flushPending;
+};
+
 void aveLogCallback(const char* prefix, const AVELogLevel level, const char* data)
 {
     if (level >= s_wk.m_logLevel && s_wk.m_logLevel != eOff)
@@ -235,27 +405,30 @@ void aveLogCallback(const char* prefix, const AVELogLevel level, const char* dat
         }
     }
 
-    if (!s_wk.m_client)
-        return;
-
-    if(sendAllToBrowser == false)
+    int metricLine = MultiPatternMatcher::kNoMatch;
+    if (level == eMetric)
     {
-        if(level != eMetric)
-            return;
+        metricLine = metricLineMatcher().find(data);
+        if (metricLine != MultiPatternMatcher::kNoMatch)
+            AVEMetrics::addLine(static_cast<AVEMetrics::LineType>(metricLine), data);
 
-        if (strstr(data, "HttpRequestEnd")==0 && strstr(data, "TuneTime")==0 && strstr(data, "---------> Resume")==0)
-            return;
+        // Tune time is logged once the first frame is out.
+        if (metricLine == AVEMetrics::TuneTime)
+        {
+            g_main_context_invoke(nullptr, [](gpointer) -> gboolean {
+                MemoryPressurePolicy::onFirstFrame();
+                return G_SOURCE_REMOVE;
+            }, nullptr);
+        }
     }
 
-    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onAVELog"));
-    WKRetainPtr<WKStringRef> prefixRef = adoptWK(WKStringCreateWithUTF8CString(prefix));
-    WKRetainPtr<WKUInt64Ref> levelRef = adoptWK(WKUInt64Create(level));
-    WKRetainPtr<WKStringRef> dataRef = adoptWK(WKStringCreateWithUTF8CString(data));
+    if (!s_wk.m_client)
+        return;
 
-    WKTypeRef params[] = {prefixRef.get(), levelRef.get(), dataRef.get()};
-    WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+    if (sendAllToBrowser == false && metricLine == MultiPatternMatcher::kNoMatch)
+        return;
 
-    WKBundlePagePostMessage(s_wk.m_client, nameRef.get(), arrRef.get());
+    AVELogForwarder::singleton().push(prefix, level, data);
 }
 
 void setAVELogLevel(uint64_t level)
@@ -315,6 +488,12 @@ void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef fram
     }
 }
 
+static void loadBindings(JSGlobalContextRef context)
+{
+    loadAVEJavaScriptBindings(context);
+    installAVELoggingCallback();
+}
+
 void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
 {
     RDKLOG_INFO("");
@@ -324,8 +503,13 @@ void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
         if (mainFrame == frame)
         {
             JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(frame);
-            loadAVEJavaScriptBindings(context);
-            installAVELoggingCallback();
+            if (LazyBinding::enabled())
+            {
+                static const std::vector<std::string> globals = LazyBinding::globalsFromEnv("WPE_LAZY_AVE_GLOBALS", "AVEPlayer");
+                if (LazyBinding::install(context, globals, loadBindings))
+                    return;
+            }
+            loadBindings(context);
         }
     }
 }
@@ -349,18 +533,8 @@ void onSetAVESessionToken(WKTypeRef messageBody)
     RDKLOG_TRACE("Token=%s", token.c_str());
 
     setAccessSessionToken(token.c_str());
-
-    // Stop memory pressure handler for tune
-    static int gResumePressureHandlerTag = 0;
-    static int gTuneTimeoutSeconds = 20;
-    if (gResumePressureHandlerTag)
-        g_source_remove(gResumePressureHandlerTag);
-    WKBundleMemoryPressureHandlerStop();
-    gResumePressureHandlerTag = g_timeout_add_seconds_full(G_PRIORITY_DEFAULT_IDLE, gTuneTimeoutSeconds, [](gpointer) -> gboolean {
-        gResumePressureHandlerTag = 0;
-        WKBundleMemoryPressureHandlerStart();
-        return G_SOURCE_REMOVE;
-    }, nullptr, nullptr);
+    AVEMetrics::startSession();
+    MemoryPressurePolicy::onTuneStart();
 }
 
 void onSetAVEEnabled(WKTypeRef messageBody)
@@ -389,6 +563,29 @@ void onSetAVELogLevel(WKTypeRef messageBody)
     setAVELogLevel(level);
 }
 
+void onGetAVEMetrics(WKTypeRef messageBody)
+{
+    if (WKGetTypeID(messageBody) != WKUInt64GetTypeID())
+    {
+        RDKLOG_ERROR("Unexpected param type.");
+        return;
+    }
+
+    if (!s_wk.m_client)
+        return;
+
+    std::string metrics = AVEMetrics::toJSON();
+    RDKLOG_TRACE("Return AVE metrics: '%s'", metrics.c_str());
+
+    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onAVEMetrics"));
+    WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(metrics.c_str()));
+
+    WKTypeRef params[] = {messageBody, bodyRef.get()};
+    WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+
+    WKBundlePagePostMessage(s_wk.m_client, nameRef.get(), arrRef.get());
+}
+
 bool didReceiveMessageToPage(WKStringRef messageName, WKTypeRef messageBody)
 {
     if (WKStringIsEqualToUTF8CString(messageName, "setAVESessionToken"))
@@ -406,6 +603,11 @@ bool didReceiveMessageToPage(WKStringRef messageName, WKTypeRef messageBody)
         onSetAVELogLevel(messageBody);
         return true;
     }
+    if (WKStringIsEqualToUTF8CString(messageName, "getAVEMetrics"))
+    {
+        onGetAVEMetrics(messageBody);
+        return true;
+    }
     return false;
 }
 
@@ -0,0 +1,477 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "logger.h"
+#include "BinaryLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+namespace RDK
+{
+namespace BinaryLog
+{
+
+std::atomic<bool> gEnabled {false};
+
+namespace
+{
+
+using namespace BinaryLogFormat;
+
+const size_t kBufferSize = 64 * 1024;
+const uint64_t kMaxBufferAgeNs = 1000000000ull;
+// Buffers in use and queued, about 4 MB. Records are dropped when none is free.
+const size_t kMaxChunks = 64;
+const unsigned kWriterIntervalMs = 500;
+
+// Log file with its site table. The site table is written again after
+// every rotation so each file can be decoded on its own.
+// Only the writer thread, and the exit handler, write to the file.
+class LogFile
+{
+public:
+    LogFile(const std::string& path, size_t maxSize)
+        : _path(path)
+        , _maxSize(maxSize)
+    {
+    }
+
+    const std::string& path() const { return _path; }
+
+    bool open()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        int fd = openExclusiveLogFile(_path, O_WRONLY);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, 0) < 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        return startLocked(fd);
+    }
+
+    // Assigns the id right away, the entry is written by the writer thread.
+    uint32_t registerSite(Site& site)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        uint32_t id = site.id.load(std::memory_order_relaxed);
+        if (id)
+            return id;
+
+        _sites.push_back(&site);
+        id = _sites.size();
+        appendSite(_pendingSites, site, id);
+
+        site.id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    void writeBlock(uint32_t tid, const uint8_t* data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        writePendingSitesLocked();
+        writeBlockLocked(tid, data, size);
+    }
+
+    void writePendingSites()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        writePendingSitesLocked();
+    }
+
+private:
+    static void appendSite(std::vector<uint8_t>& entry, const Site& site, uint32_t id)
+    {
+        uint16_t formatLength = std::min(strlen(site.format), kMaxStringLength);
+        uint16_t fileLength = std::min(strlen(site.file), kMaxStringLength);
+        uint16_t funcLength = std::min(strlen(site.func), kMaxStringLength);
+        uint32_t line = site.line;
+
+        size_t offset = entry.size();
+        entry.resize(offset + kSiteHeaderSize + formatLength + fileLength + funcLength);
+        uint8_t* p = entry.data() + offset;
+        p = Encoding::put<uint8_t>(p, SiteEntry);
+        p = Encoding::put<uint32_t>(p, id);
+        p = Encoding::put<uint32_t>(p, line);
+        p = Encoding::put<uint16_t>(p, formatLength);
+        p = Encoding::put<uint16_t>(p, fileLength);
+        p = Encoding::put<uint16_t>(p, funcLength);
+        p = Encoding::put(p, site.format, formatLength);
+        p = Encoding::put(p, site.file, fileLength);
+        Encoding::put(p, site.func, funcLength);
+    }
+
+    bool writeAll(const void* data, size_t size)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        while (size)
+        {
+            ssize_t written = ::write(_fd, p, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            p += written;
+            size -= written;
+            _size += written;
+        }
+        return true;
+    }
+
+    // Writes the header and every known site to the empty file fd.
+    bool startLocked(int fd)
+    {
+        _fd = fd;
+        _size = 0;
+        FileHeader header;
+        memcpy(header.magic, kFileMagic, sizeof(header.magic));
+        header.byteOrder = kByteOrderMark;
+        header.version = kVersion;
+        if (!writeAll(&header, sizeof(header)))
+            return false;
+
+        // Sites still pending are part of the table written here.
+        _pendingSites.clear();
+        if (_sites.empty())
+            return true;
+
+        std::vector<uint8_t> entries;
+        for (size_t i = 0; i < _sites.size(); ++i)
+            appendSite(entries, *_sites[i], i + 1);
+        return writeBlockLocked(0, entries.data(), entries.size());
+    }
+
+    // The lock of the old file moves with it to <path>.1, the new one is locked again.
+    void rotateLocked()
+    {
+        std::string previous = _path + ".1";
+        rename(_path.c_str(), previous.c_str());
+        ::close(_fd);
+        _fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (_fd < 0)
+            return;
+        (void) flock(_fd, LOCK_EX | LOCK_NB);
+        startLocked(_fd);
+    }
+
+    void writePendingSitesLocked()
+    {
+        if (_pendingSites.empty())
+            return;
+        std::vector<uint8_t> entries;
+        entries.swap(_pendingSites);
+        writeBlockLocked(0, entries.data(), entries.size());
+    }
+
+    bool writeBlockLocked(uint32_t tid, const uint8_t* data, size_t size)
+    {
+        if (_fd < 0)
+            return false;
+
+        if (_size > sizeof(FileHeader) && _size + sizeof(BlockHeader) + size > _maxSize)
+        {
+            rotateLocked();
+            if (_fd < 0)
+                return false;
+        }
+
+        BlockHeader header;
+        header.magic = kBlockMagic;
+        header.tid = tid;
+        header.size = size;
+        return writeAll(&header, sizeof(header)) && writeAll(data, size);
+    }
+
+    std::string _path;
+    const size_t _maxSize;
+    std::mutex _mutex;
+    int _fd {-1};
+    size_t _size {0};
+    std::vector<const Site*> _sites;
+    std::vector<uint8_t> _pendingSites;
+};
+
+LogFile* gFile = nullptr;
+
+// Records of one thread, written to the file as one block.
+struct Chunk
+{
+    uint32_t tid;
+    size_t used {0};
+    uint8_t data[kBufferSize];
+};
+
+typedef std::unique_ptr<Chunk> ChunkPtr;
+
+// Chunks handed from the logging threads to the writer thread and back.
+std::mutex gQueueMutex;
+std::condition_variable gQueueCondition;
+std::deque<ChunkPtr> gFullChunks;
+std::vector<ChunkPtr> gFreeChunks;
+size_t gChunkCount = 0;
+
+std::atomic<unsigned> gDropped {0};
+
+ChunkPtr takeChunk()
+{
+    std::lock_guard<std::mutex> lock(gQueueMutex);
+    if (!gFreeChunks.empty())
+    {
+        ChunkPtr chunk = std::move(gFreeChunks.back());
+        gFreeChunks.pop_back();
+        return chunk;
+    }
+    if (gChunkCount == kMaxChunks)
+        return nullptr;
+    ++gChunkCount;
+    return ChunkPtr(new Chunk());
+}
+
+void submitChunk(ChunkPtr chunk, bool wake)
+{
+    {
+        std::lock_guard<std::mutex> lock(gQueueMutex);
+        gFullChunks.push_back(std::move(chunk));
+    }
+    if (wake)
+        gQueueCondition.notify_one();
+}
+
+// The mutex is only contended by the writer thread taking an idle chunk.
+struct ThreadBuffer
+{
+    ThreadBuffer();
+    ~ThreadBuffer();
+
+    // Hands the chunk to the writer thread.
+    void submitLocked(bool wake)
+    {
+        if (!chunk || !chunk->used)
+            return;
+        chunk->tid = tid;
+        submitChunk(std::move(chunk), wake);
+    }
+
+    std::mutex mutex;
+    uint32_t tid;
+    ChunkPtr chunk;
+    // Timestamp of the first record in chunk.
+    uint64_t startedAt {0};
+};
+
+std::mutex gBuffersMutex;
+std::unordered_set<ThreadBuffer*>* gBuffers = nullptr;
+
+ThreadBuffer::ThreadBuffer()
+    : tid(syscall(SYS_gettid))
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    gBuffers->insert(this);
+}
+
+ThreadBuffer::~ThreadBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(gBuffersMutex);
+        gBuffers->erase(this);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    submitLocked(true);
+}
+
+thread_local std::unique_ptr<ThreadBuffer> tBuffer;
+
+uint64_t now()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    return spec.tv_sec * 1000000000ull + spec.tv_nsec;
+}
+
+// Takes the chunks whose first record is older than before, no I/O under the locks.
+void collectChunks(uint64_t before)
+{
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    for (ThreadBuffer* buffer : *gBuffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (buffer->startedAt < before)
+            buffer->submitLocked(false);
+    }
+}
+
+void writeChunks()
+{
+    gFile->writePendingSites();
+    for (;;)
+    {
+        ChunkPtr chunk;
+        {
+            std::lock_guard<std::mutex> lock(gQueueMutex);
+            if (gFullChunks.empty())
+                break;
+            chunk = std::move(gFullChunks.front());
+            gFullChunks.pop_front();
+        }
+
+        gFile->writeBlock(chunk->tid, chunk->data, chunk->used);
+        chunk->used = 0;
+
+        std::lock_guard<std::mutex> lock(gQueueMutex);
+        gFreeChunks.push_back(std::move(chunk));
+    }
+}
+
+void reportDropped()
+{
+    unsigned dropped = gDropped.exchange(0, std::memory_order_relaxed);
+    if (!dropped)
+        return;
+    static Site site("dropped %u record(s), no free buffer or record too large", __FILE__, __LINE__, __func__);
+    write(site, WARNING_LEVEL, dropped);
+}
+
+// Writes out full chunks as they are handed over, and the chunks of
+// threads that stopped logging, reserve() only hands over on its next record.
+gpointer writer(gpointer)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(gQueueMutex);
+            gQueueCondition.wait_for(lock, std::chrono::milliseconds(kWriterIntervalMs), [] {
+                return !gFullChunks.empty();
+            });
+        }
+
+        reportDropped();
+        collectChunks(now() - kMaxBufferAgeNs);
+        writeChunks();
+    }
+    return nullptr;
+}
+
+void flushAll()
+{
+    collectChunks(UINT64_MAX);
+    writeChunks();
+}
+
+} // namespace
+
+void init()
+{
+    const char* path = getenv("RDKBROWSER2_BINARY_LOG");
+    if (!path || !*path || gFile)
+        return;
+
+    size_t maxSize = 4096 * 1024;
+    const char* maxKB = getenv("RDKBROWSER2_BINARY_LOG_MAX_KB");
+    if (maxKB && atoi(maxKB) > 0)
+        maxSize = atoi(maxKB) * 1024;
+
+    // Never deleted, chunks may be written until the process exits.
+    LogFile* file = new LogFile(path, std::max(maxSize, 2 * kBufferSize));
+    if (!file->open())
+    {
+        RDK::log(ERROR_LEVEL, __func__, __FILE__, __LINE__, 0,
+            "Cannot open binary log %s: %s", file->path().c_str(), strerror(errno));
+        delete file;
+        return;
+    }
+
+    gFile = file;
+    gBuffers = new std::unordered_set<ThreadBuffer*>();
+    atexit(flushAll);
+    g_thread_unref(g_thread_new("RDKBinaryLogWriter", writer, nullptr));
+    gEnabled = true;
+
+    RDK::log(INFO_LEVEL, __func__, __FILE__, __LINE__, 0,
+        "Logging to binary file %s, decode with BinaryLogDecode", file->path().c_str());
+}
+
+uint32_t registerSite(Site& site)
+{
+    return gFile->registerSite(site);
+}
+
+uint8_t* reserve(size_t size, uint64_t timestamp)
+{
+    if (size > kBufferSize)
+    {
+        gDropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (!tBuffer)
+        tBuffer.reset(new ThreadBuffer());
+
+    ThreadBuffer& buffer = *tBuffer;
+    buffer.mutex.lock();
+    if (buffer.chunk && (buffer.chunk->used + size > kBufferSize || timestamp - buffer.startedAt > kMaxBufferAgeNs))
+        buffer.submitLocked(true);
+
+    if (!buffer.chunk)
+    {
+        buffer.chunk = takeChunk();
+        if (!buffer.chunk)
+        {
+            buffer.mutex.unlock();
+            gDropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    if (!buffer.chunk->used)
+        buffer.startedAt = timestamp;
+    uint8_t* p = buffer.chunk->data + buffer.chunk->used;
+    buffer.chunk->used += size;
+    return p;
+}
+
+void commit()
+{
+    tBuffer->mutex.unlock();
+}
+
+} // namespace BinaryLog
+} // namespace RDK
@@ -0,0 +1,217 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RDK_BINARY_LOG_H
+#define RDK_BINARY_LOG_H
+
+#include "logger.h"
+#include "BinaryLogFormat.h"
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <initializer_list>
+#include <type_traits>
+
+namespace RDK
+{
+
+/**
+ * Deferred-format logging, enabled with RDKBROWSER2_BINARY_LOG=<file>.
+ * A call site records its format id, a timestamp and the raw arguments
+ * into a per-thread buffer, only strings are copied. Formatting is done
+ * offline by tools/BinaryLogDecode. A background writer thread does all
+ * file I/O, a record reaches the file about one to two seconds after it
+ * was logged at the latest. Records are dropped, and the drop is logged,
+ * when no buffer is free or a record is larger than a buffer.
+ * Each process writes its own file, see openExclusiveLogFile().
+ * Records are not copied to LogRing, only text messages are.
+ */
+namespace BinaryLog
+{
+
+/**
+ * Static description of a logging call site.
+ * Gets an id and is written to the log file the first time it is used.
+ */
+struct Site
+{
+    constexpr Site(const char* format, const char* file, int line, const char* func)
+        : format(format), file(file), line(line), func(func)
+    {
+    }
+
+    const char* const format;
+    const char* const file;
+    const int line;
+    const char* const func;
+    std::atomic<uint32_t> id {0};
+};
+
+extern std::atomic<bool> gEnabled;
+
+/**
+ * @brief Check whether messages of the level go to the binary log
+ * Fatal messages always take the text path before aborting.
+ */
+inline bool isEnabled(LogLevel level)
+{
+    return level != FATAL_LEVEL && gEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Open the log file named by RDKBROWSER2_BINARY_LOG, called by logger_init()
+ */
+void init();
+
+/**
+ * @brief Assign an id to the site and write its description to the file
+ */
+uint32_t registerSite(Site& site);
+
+/**
+ * @brief Reserve size bytes in the calling thread's buffer
+ * The buffer is handed to the writer thread first when it is full or when
+ * its oldest record is more than a second older than timestamp. The writer
+ * thread also takes buffers of idle threads once they are that old.
+ * Must be followed by commit() on the same thread.
+ * Returns nullptr if the record can't be stored.
+ */
+uint8_t* reserve(size_t size, uint64_t timestamp);
+
+/**
+ * @brief Finish the record started by reserve()
+ */
+void commit();
+
+namespace Encoding
+{
+
+inline uint8_t* put(uint8_t* p, const void* data, size_t size)
+{
+    memcpy(p, data, size);
+    return p + size;
+}
+
+template <typename T>
+inline uint8_t* put(uint8_t* p, T value)
+{
+    return put(p, &value, sizeof(value));
+}
+
+template <typename T, typename Enable = void>
+struct Arg;
+
+template <typename T>
+struct Arg<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+{
+    static size_t size(T) { return 1 + 8; }
+    static uint8_t* write(uint8_t* p, T value)
+    {
+        typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T>>::type::type Integral;
+        if (std::is_signed<Integral>::value)
+        {
+            p = put<uint8_t>(p, BinaryLogFormat::SignedArg);
+            return put<int64_t>(p, static_cast<Integral>(value));
+        }
+        p = put<uint8_t>(p, BinaryLogFormat::UnsignedArg);
+        return put<uint64_t>(p, static_cast<Integral>(value));
+    }
+};
+
+template <typename T>
+struct Arg<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static size_t size(T) { return 1 + 8; }
+    static uint8_t* write(uint8_t* p, T value)
+    {
+        p = put<uint8_t>(p, BinaryLogFormat::DoubleArg);
+        return put<double>(p, value);
+    }
+};
+
+template <typename T>
+struct Arg<T*, typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type>
+{
+    static size_t size(const T*) { return 1 + 8; }
+    static uint8_t* write(uint8_t* p, const T* value)
+    {
+        p = put<uint8_t>(p, BinaryLogFormat::PointerArg);
+        return put<uint64_t>(p, reinterpret_cast<uintptr_t>(value));
+    }
+};
+
+template <typename T>
+struct Arg<T*, typename std::enable_if<std::is_same<typename std::remove_cv<T>::type, char>::value>::type>
+{
+    static size_t length(const char* value)
+    {
+        size_t length = value ? strlen(value) : 6;
+        return length < BinaryLogFormat::kMaxStringLength ? length : BinaryLogFormat::kMaxStringLength;
+    }
+    static size_t size(const char* value) { return 1 + 2 + length(value); }
+    static uint8_t* write(uint8_t* p, const char* value)
+    {
+        uint16_t length = Arg::length(value);
+        p = put<uint8_t>(p, BinaryLogFormat::StringArg);
+        p = put<uint16_t>(p, length);
+        return put(p, value ? value : "(null)", length);
+    }
+};
+
+} // namespace Encoding
+
+template <typename... Args>
+void write(Site& site, LogLevel level, const Args&... args)
+{
+    using namespace Encoding;
+
+    uint32_t id = site.id.load(std::memory_order_acquire);
+    if (!id && !(id = registerSite(site)))
+        return;
+
+    size_t size = BinaryLogFormat::kRecordHeaderSize;
+    (void) std::initializer_list<int> {
+        (size += Arg<typename std::decay<Args>::type>::size(args), 0)...
+    };
+
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    uint64_t timestamp = spec.tv_sec * 1000000000ull + spec.tv_nsec;
+
+    uint8_t* p = reserve(size, timestamp);
+    if (!p)
+        return;
+
+    p = put<uint8_t>(p, BinaryLogFormat::RecordEntry);
+    p = put<uint8_t>(p, level);
+    p = put<uint8_t>(p, sizeof...(Args));
+    p = put<uint32_t>(p, id);
+    p = put<uint64_t>(p, timestamp);
+    (void) std::initializer_list<int> {
+        (p = Arg<typename std::decay<Args>::type>::write(p, args), 0)...
+    };
+    (void) p;
+
+    commit();
+}
+
+} // namespace BinaryLog
+} // namespace RDK
+
+#endif // RDK_BINARY_LOG_H
@@ -0,0 +1,84 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RDK_BINARY_LOG_FORMAT_H
+#define RDK_BINARY_LOG_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * On-disk layout of the binary log, shared by the logger and the decoder
+ * in tools/. Values are stored in the byte order of the writing device.
+ *
+ * file    := FileHeader block*
+ * block   := BlockHeader entry*          (BlockHeader::size bytes of entries)
+ * entry   := site | record
+ * site    := 'S' u32 id, u32 line, u16 formatLength, u16 fileLength,
+ *            u16 funcLength, format, file, func
+ * record  := 'R' u8 level, u8 argc, u32 site id, u64 timestamp (ns, realtime), arg*
+ * arg     := 'i' i64 | 'u' u64 | 'f' double | 'p' u64 | 's' u16 length, bytes
+ */
+namespace RDK
+{
+namespace BinaryLogFormat
+{
+
+const char kFileMagic[8] = {'R', 'D', 'K', 'B', 'L', 'O', 'G', '1'};
+const uint32_t kByteOrderMark = 0x01020304;
+const uint32_t kVersion = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t version;
+};
+
+const uint32_t kBlockMagic = 0x4b4c4252; // "RBLK"
+
+struct BlockHeader
+{
+    uint32_t magic;
+    uint32_t tid;
+    uint32_t size;
+};
+
+enum EntryType : uint8_t
+{
+    SiteEntry = 'S',
+    RecordEntry = 'R'
+};
+
+enum ArgType : uint8_t
+{
+    SignedArg = 'i',
+    UnsignedArg = 'u',
+    DoubleArg = 'f',
+    PointerArg = 'p',
+    StringArg = 's'
+};
+
+const size_t kSiteHeaderSize = 1 + 4 + 4 + 2 + 2 + 2;
+const size_t kRecordHeaderSize = 1 + 1 + 1 + 4 + 8;
+const size_t kMaxStringLength = 0xFFFF;
+
+} // namespace BinaryLogFormat
+} // namespace RDK
+
+#endif // RDK_BINARY_LOG_FORMAT_H
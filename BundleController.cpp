@@ -18,6 +18,7 @@
 */
 #include "BundleController.h"
 #include "Proxy.h"
+#include "ScriptCache.h"
 
 #ifdef ENABLE_AVE
 #include "AVESupport.h"
@@ -28,13 +29,19 @@
 #ifdef ENABLE_AAMP_JSBINDING
 #include "AAMPJSController.h"
 #endif
+#include "MemoryPressurePolicy.h"
 #include "NavMetrics.h"
+#include "ResourceMetrics.h"
+#include "Watchdog.h"
 #ifdef ENABLE_VIRTUAL_KEYBOARD
 #include "VirtualKeyboard.h"
 #endif
 #ifdef ENABLE_APP_SECRET
 #include "ApplicationSecret.h"
 #endif
+#ifdef ENABLE_SECURITY_TOKEN
+#include "SecurityAgent.h"
+#endif
 
 #include "logger.h"
 #include "utils.h"
@@ -45,20 +52,34 @@
 #include <WebKit/WKBundleFrame.h>
 #include <WebKit/WKBundlePagePrivate.h>
 #include <WebKit/WKBundlePageLoaderClient.h>
+#include <WebKit/WKBundleScriptWorld.h>
 #include <WebKit/WKRetainPtr.h>
+#include <WebKit/WKSecurityOriginRef.h>
 #include <WebKit/WKURL.h>
 #include <WebKit/WKNumber.h>
 
 #include "ClassDefinition.h"
+#include "HostMatcher.h"
 
 #include <sys/prctl.h>
+#include <unordered_map>
 
 #define UNUSED(x) (void) x
 
-static std::string g_currentURL;
+// Main frame URL per page, replaced as a whole on navigation.
+static std::unordered_map<WKBundlePageRef, Utils::SharedURL> g_pageURLs;
+
 namespace Utils {
-    std::string GetURL() {
-        return (g_currentURL);
+    SharedURL GetURL(JSContextRef context) {
+        WKBundleFrameRef frame = WKBundleFrameForJavaScriptContext(context);
+        if (!frame)
+            return nullptr;
+        return GetURL(WKBundleFrameGetPage(frame));
+    }
+
+    SharedURL GetURL(WKBundlePageRef page) {
+        auto it = g_pageURLs.find(page);
+        return it != g_pageURLs.end() ? it->second : nullptr;
     }
 }
 
@@ -69,39 +90,71 @@ namespace
 static void injectUserScript(WKBundlePageRef page, const char* path)
 {
     RDKLOG_INFO("");
-    std::ifstream file;
-    file.open(path);
-    if (!file.is_open())
+    JSBridge::ScriptAssetPtr script = JSBridge::ScriptCache::singleton().get(path);
+    if (!script)
         return;
 
-    std::string content;
-    content.assign((std::istreambuf_iterator<char>(file)),(std::istreambuf_iterator<char>()));
-    file.close();
-
-    WKRetainPtr<WKStringRef> str = adoptWK(WKStringCreateWithUTF8CString(content.c_str()));
-    WKBundlePageAddUserScript(page, str.get(), kWKInjectAtDocumentStart, kWKInjectInAllFrames);
+    WKBundlePageAddUserScript(page, script->wkSource.get(), kWKInjectAtDocumentStart, kWKInjectInAllFrames);
 }
 #endif
 
+// Hosts of partner apps that bring their own player and must not get AVE/AAMP bindings.
+static const char* const kDefaultBindingDenyRules[] = {
+    ".youtube.com",
+    ".atv-ext.amazon.com",
+    ".ccast.api.amazonvideo.com",
+    ".ccast.api.av-gamma.com",
+};
+
+static void loadBindingRules(HostMatcher& rules, const char* path)
+{
+    GKeyFile* keyFile = g_key_file_new();
+    if (g_key_file_load_from_file(keyFile, path, G_KEY_FILE_NONE, nullptr) &&
+        g_key_file_has_group(keyFile, "Bindings"))
+    {
+        const struct { const char* key; HostMatcher::Action action; } lists[] = {
+            { "Allow", HostMatcher::Action::Allow },
+            { "Deny", HostMatcher::Action::Deny },
+        };
+        for (const auto& list : lists)
+        {
+            gchar** hosts = g_key_file_get_string_list(keyFile, "Bindings", list.key, nullptr, nullptr);
+            for (gchar** host = hosts; host && *host; ++host)
+                rules.add(g_strstrip(*host), list.action);
+            g_strfreev(hosts);
+        }
+        RDKLOG_INFO("Loaded binding host rules from %s", path);
+    }
+    else
+    {
+        for (const char* rule : kDefaultBindingDenyRules)
+            rules.add(rule, HostMatcher::Action::Deny);
+    }
+    g_key_file_free(keyFile);
+}
+
 bool shouldInjectBindings(WKURLRef url)
 {
+    static HostMatcher& rules = *[]() {
+        HostMatcher* matcher = new HostMatcher();
+        loadBindingRules(*matcher, "/etc/injectedbundle/bindings.conf");
+        return matcher;
+    }();
+
     if (url == nullptr)
         return false;
     WKRetainPtr<WKStringRef> wkHost = adoptWK(WKURLCopyHostName(url));
     if (wkHost.get() == nullptr)
         return false;
     std::string hostStr = Utils::toStdString(wkHost.get());
-    if (hostStr.empty() || hostStr.find("youtube.com") != std::string::npos)
+    if (hostStr.empty())
         return false;
-    if (hostStr.find("atv-ext.amazon.com") != std::string::npos ||
-        hostStr.find("ccast.api.amazonvideo.com") != std::string::npos ||
-        hostStr.find("ccast.api.av-gamma.com") != std::string::npos)
-        return false;
-    return true;
+    return rules.match(hostStr) != HostMatcher::Action::Deny;
 }
 
 void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef frame, WKTypeRef*, const void *)
 {
+    Watchdog::Scope watchdog(Watchdog::DidStartProvisionalLoadForFrame);
     WKBundleFrameRef mainFrame = WKBundlePageGetMainFrame(page);
     if (mainFrame == frame)
     {
@@ -115,6 +168,8 @@ void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef fram
         }
     }
 
+    NavMetrics::didStartProvisionalLoadForFrame(page, frame);
+
 #ifdef ENABLE_AVE
     AVESupport::didStartProvisionalLoadForFrame(page, frame);
 #endif
@@ -124,11 +179,37 @@ void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef fram
 #endif
 }
 
+// Publishes the main frame URL for Utils::GetURL(), from commit on.
+static void updatePageURL(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    if (WKBundleFrameIsMainFrame(frame))
+    {
+        WKRetainPtr<WKURLRef> wkUrl = adoptWK(WKBundleFrameCopyURL(frame));
+        WKRetainPtr<WKStringRef> wkUrlStr = adoptWK(WKURLCopyString(wkUrl.get()));
+        std::string urlStr = Utils::toStdString(wkUrlStr.get());
+
+        Utils::SharedURL& current = g_pageURLs[page];
+        if (current && *current == urlStr)
+            return;
+#ifdef ENABLE_SECURITY_TOKEN
+        if (current)
+            SecurityAgent::didChangeURL(*current);
+#endif
+        current = std::make_shared<const std::string>(std::move(urlStr));
+    }
+}
+
 void didCommitLoad(WKBundlePageRef page,
     WKBundleFrameRef frame, WKTypeRef*, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::DidCommitLoadForFrame);
+    updatePageURL(page, frame);
     JSBridge::Proxy::singleton().didCommitLoad(page, frame);
 
+#ifdef ENABLE_SECURITY_TOKEN
+    SecurityAgent::didCommitLoad(page, frame);
+#endif
+
     WKRetainPtr<WKURLRef> wkUrl = adoptWK(WKBundleFrameCopyURL(frame));
     WKRetainPtr<WKStringRef> wkUrlStr = adoptWK(WKURLCopyString(wkUrl.get()));
     std::string url = Utils::toStdString(wkUrlStr.get());
@@ -151,6 +232,7 @@ void didCommitLoad(WKBundlePageRef page,
 
 bool shouldGoToBackForwardListItem(WKBundlePageRef, WKBundleBackForwardListItemRef item, WKTypeRef*, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::ShouldGoToBackForwardListItem);
      if (item && WKURLIsEqual(adoptWK(WKBundleBackForwardListItemCopyURL(item)).get(),
                               adoptWK(WKURLCreateWithUTF8CString("about:blank")).get()))
         return false;
@@ -159,24 +241,52 @@ bool shouldGoToBackForwardListItem(WKBundlePageRef, WKBundleBackForwardListItemR
 
 static void didHandleOnloadEventsForFrame(WKBundlePageRef page, WKBundleFrameRef frame, const void *)
 {
+    Watchdog::Scope watchdog(Watchdog::DidHandleOnloadEventsForFrame);
     NavMetrics::didHandleOnloadEventsForFrame(page, frame);
 }
 
-static void updateGlobalURL(WKBundleFrameRef frame)
+// "scheme://host", or "scheme://host:port" for a non-default port, of the frame's security origin.
+static std::string frameOrigin(WKBundleFrameRef frame)
 {
-    if (WKBundleFrameIsMainFrame(frame))
-    {
-        WKURLRef Url = WKBundleFrameCopyURL(frame);
-        WKStringRef urlString = WKURLCopyString(Url);
-        std::string urlStr = Utils::toStdString(urlString);
-        g_currentURL = urlStr.c_str();
-        WKRelease(urlString);
-        WKRelease(Url);
-    }
+    WKRetainPtr<WKSecurityOriginRef> securityOrigin = adoptWK(WKBundleFrameCopySecurityOrigin(frame));
+    if (!securityOrigin)
+        return { };
+
+    WKRetainPtr<WKStringRef> wkProtocol = adoptWK(WKSecurityOriginCopyProtocol(securityOrigin.get()));
+    WKRetainPtr<WKStringRef> wkHost = adoptWK(WKSecurityOriginCopyHost(securityOrigin.get()));
+    std::string origin = wkProtocol ? Utils::toStdString(wkProtocol.get()) : "";
+    origin += "://";
+    if (wkHost)
+        origin += Utils::toStdString(wkHost.get());
+    // 0 when the port is the scheme's default one.
+    unsigned short port = WKSecurityOriginGetPort(securityOrigin.get());
+    if (port)
+        origin += ":" + std::to_string(port);
+    return origin;
+}
+
+static void didClearWindowObjectForFrame(WKBundlePageRef page, WKBundleFrameRef frame, WKBundleScriptWorldRef scriptWorld)
+{
+    using WPEFramework::JavaScript::ClassDefinition;
+
+    NavMetrics::didClearWindowObjectForFrame(page, frame, scriptWorld);
+
+    WPEFramework::JavaScript::InjectionTarget target;
+    target.isMainFrame = WKBundlePageGetMainFrame(page) == frame;
+    target.isNormalWorld = scriptWorld == WKBundleScriptWorldNormalWorld();
+    if (ClassDefinition::NeedsOrigin())
+        target.origin = frameOrigin(frame);
+
+    if (!ClassDefinition::ShouldInjectAny(target))
+        return;
+
+    JSGlobalContextRef context = WKBundleFrameGetJavaScriptContextForWorld(frame, scriptWorld);
+    WPEFramework::JavaScript::injectJSClass(context, target);
 }
 
 WKURLRequestRef willSendRequestForFrame(WKBundlePageRef page, WKBundleFrameRef, uint64_t, WKURLRequestRef request, WKURLResponseRef, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::WillSendRequestForFrame);
     if (filterRequest(page, request))
         return nullptr;
 
@@ -187,11 +297,13 @@ WKURLRequestRef willSendRequestForFrame(WKBundlePageRef page, WKBundleFrameRef,
 
 static WKBundlePagePolicyAction decidePolicyForNavigationAction(WKBundlePageRef, WKBundleFrameRef, WKBundleNavigationActionRef, WKURLRequestRef, WKTypeRef*, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::DecidePolicyForNavigationAction);
     return WKBundlePagePolicyActionUse;
 }
 
 static void didFocusTextField(WKBundlePageRef page, WKBundleNodeHandleRef, WKBundleFrameRef frame, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::DidFocusTextField);
 #if defined(ENABLE_VIRTUAL_KEYBOARD)
     VirtualKeyboard::didFocusTextField(page, frame);
 #else
@@ -202,6 +314,7 @@ static void didFocusTextField(WKBundlePageRef page, WKBundleNodeHandleRef, WKBun
 
 void didCreatePage(WKBundleRef, WKBundlePageRef page, const void* clientInfo)
 {
+    Watchdog::Scope watchdog(Watchdog::DidCreatePage);
     JSBridge::Proxy::singleton().setClient(page);
 
 #ifdef ENABLE_AVE
@@ -216,29 +329,42 @@ void didCreatePage(WKBundleRef, WKBundlePageRef page, const void* clientInfo)
         nullptr, // didFailProvisionalLoadWithErrorForFrame;
         didCommitLoad, // didCommitLoadForFrame;
         nullptr, // didFinishDocumentLoadForFrame;
-        // didFinishLoadForFrame;
-        [](WKBundlePageRef, WKBundleFrameRef frame, WKTypeRef*, const void*) {
-            updateGlobalURL(frame);
-        },
+        nullptr, // didFinishLoadForFrame;
         nullptr, // didFailLoadWithErrorForFrame;
-        nullptr, // didSameDocumentNavigationForFrame;
+        // didSameDocumentNavigationForFrame;
+        [](WKBundlePageRef page, WKBundleFrameRef frame, WKSameDocumentNavigationType, WKTypeRef*, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidSameDocumentNavigationForFrame);
+            updatePageURL(page, frame);
+        },
         nullptr, // didReceiveTitleForFrame;
-        nullptr, // didFirstLayoutForFrame;
-        nullptr, // didFirstVisuallyNonEmptyLayoutForFrame;
+        // didFirstLayoutForFrame;
+        [](WKBundlePageRef page, WKBundleFrameRef frame, WKTypeRef*, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidFirstLayoutForFrame);
+            NavMetrics::didFirstLayoutForFrame(page, frame);
+        },
+        // didFirstVisuallyNonEmptyLayoutForFrame;
+        [](WKBundlePageRef page, WKBundleFrameRef frame, WKTypeRef*, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidFirstVisuallyNonEmptyLayoutForFrame);
+            NavMetrics::didFirstVisuallyNonEmptyLayoutForFrame(page, frame);
+        },
         nullptr, // didRemoveFrameFromHierarchy;
         nullptr, // didDisplayInsecureContentForFrame;
         nullptr, // didRunInsecureContentForFrame;
         // didClearWindowObjectForFrame;
-        [](WKBundlePageRef, WKBundleFrameRef frame, WKBundleScriptWorldRef scriptWorld, const void*) {
-            JSGlobalContextRef context = WKBundleFrameGetJavaScriptContextForWorld(frame, scriptWorld);
-            WPEFramework::JavaScript::injectJSClass(context);
+        [](WKBundlePageRef page, WKBundleFrameRef frame, WKBundleScriptWorldRef scriptWorld, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidClearWindowObjectForFrame);
+            didClearWindowObjectForFrame(page, frame, scriptWorld);
         },
         nullptr, // didCancelClientRedirectForFrame;
         nullptr, // willPerformClientRedirectForFrame;
         didHandleOnloadEventsForFrame,
 
         // Version 1.
-        nullptr, // didLayoutForFrame
+        // didLayoutForFrame
+        [](WKBundlePageRef page, WKBundleFrameRef frame, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidLayoutForFrame);
+            NavMetrics::didLayoutForFrame(page, frame);
+        },
         nullptr, // didNewFirstVisuallyNonEmptyLayout_unavailable
         nullptr, // didNewFirstVisuallyNonEmptyLayout_unavailable
         shouldGoToBackForwardListItem,
@@ -252,12 +378,32 @@ void didCreatePage(WKBundleRef, WKBundlePageRef page, const void* clientInfo)
 
     WKBundlePageResourceLoadClientV0 resourceLoadClient {
         {0, clientInfo},
-        nullptr, // didInitiateLoadForResource
+        // didInitiateLoadForResource
+        [](WKBundlePageRef page, WKBundleFrameRef, uint64_t resourceIdentifier, WKURLRequestRef request, bool, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidInitiateLoadForResource);
+            ResourceMetrics::didInitiateLoadForResource(page, resourceIdentifier, request);
+        },
         willSendRequestForFrame,
-        nullptr, // didReceiveResponseForResource
-        nullptr, // didReceiveContentLengthForResource
-        nullptr, // didFinishLoadForResource
-        nullptr // didFailLoadForResource
+        // didReceiveResponseForResource
+        [](WKBundlePageRef page, WKBundleFrameRef, uint64_t resourceIdentifier, WKURLResponseRef response, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidReceiveResponseForResource);
+            ResourceMetrics::didReceiveResponseForResource(page, resourceIdentifier, response);
+        },
+        // didReceiveContentLengthForResource
+        [](WKBundlePageRef page, WKBundleFrameRef, uint64_t resourceIdentifier, uint64_t contentLength, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidReceiveContentLengthForResource);
+            ResourceMetrics::didReceiveContentLengthForResource(page, resourceIdentifier, contentLength);
+        },
+        // didFinishLoadForResource
+        [](WKBundlePageRef page, WKBundleFrameRef, uint64_t resourceIdentifier, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidFinishLoadForResource);
+            ResourceMetrics::didFinishLoadForResource(page, resourceIdentifier);
+        },
+        // didFailLoadForResource
+        [](WKBundlePageRef page, WKBundleFrameRef, uint64_t resourceIdentifier, WKErrorRef, const void*) {
+            Watchdog::Scope watchdog(Watchdog::DidFailLoadForResource);
+            ResourceMetrics::didFailLoadForResource(page, resourceIdentifier);
+        }
     };
 
     WKBundlePageSetResourceLoadClient(page, &resourceLoadClient.base);
@@ -299,13 +445,18 @@ void didCreatePage(WKBundleRef, WKBundlePageRef page, const void* clientInfo)
 
 void willDestroyPage(WKBundleRef, WKBundlePageRef page, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::WillDestroyPage);
     removeWebFiltersForPage(page);
     removeRequestHeadersFromPage(page);
+    g_pageURLs.erase(page);
+    NavMetrics::willDestroyPage(page);
+    ResourceMetrics::removePage(page);
 }
 
 void didReceiveMessageToPage(WKBundleRef,
     WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody, const void*)
 {
+    Watchdog::Scope watchdog(Watchdog::DidReceiveMessageToPage);
     if (WKStringIsEqualToUTF8CString(messageName, "webfilters"))
     {
         setWebFiltersForPage(page, messageBody);
@@ -345,6 +496,21 @@ void didReceiveMessageToPage(WKBundleRef,
         return;
     }
 
+    if (MemoryPressurePolicy::didReceiveMessageToPage(page, messageName, messageBody))
+    {
+        return;
+    }
+
+    if (ResourceMetrics::didReceiveMessageToPage(page, messageName, messageBody))
+    {
+        return;
+    }
+
+    if (Watchdog::didReceiveMessageToPage(page, messageName, messageBody))
+    {
+        return;
+    }
+
     JSBridge::Proxy::singleton().onMessageFromClient(page, messageName, messageBody);
 }
 
@@ -30,6 +30,8 @@ namespace JavaScript {
     // Constructor: uses identifier to build class and extension name.
     ClassDefinition::ClassDefinition(const std::string& identifier)
         : _customFunctions()
+        , _jsClass(nullptr)
+        , _extNameString(nullptr)
         , _className(identifier.c_str())
         , _extName(_className)
     {
@@ -39,6 +41,15 @@ namespace JavaScript {
         // Make lower case.
         transform(_extName.begin(), _extName.end(), _extName.begin(), ::tolower);
     }
+
+    ClassDefinition::~ClassDefinition()
+    {
+        ResetJSClass();
+        if (_extNameString)
+            JSStringRelease(_extNameString);
+        for (auto pattern : _originPatterns)
+            g_pattern_spec_free(pattern);
+    }
     /* static */ ClassDefinition::ClassMap& ClassDefinition::getClassMap()
     {
         static ClassDefinition::ClassMap singleton;
@@ -73,6 +84,7 @@ namespace JavaScript {
         assert(std::find(_customFunctions.begin(), _customFunctions.end(), javaScriptFunction) == _customFunctions.end());
 
         _customFunctions.push_back(javaScriptFunction);
+        ResetJSClass();
     }
 
     // Removes JS function from class.
@@ -86,29 +98,120 @@ namespace JavaScript {
         if (index != _customFunctions.end()) {
             // Remove function from function vector.
             _customFunctions.erase(index);
+            ResetJSClass();
         }
     }
 
-    void ClassDefinition::InjectInJSWorld(ClassDefinition& classDef, JSGlobalContextRef context)
+    void ClassDefinition::SetPolicy(const InjectionPolicy& policy)
+    {
+        for (auto pattern : _originPatterns)
+            g_pattern_spec_free(pattern);
+        _originPatterns.clear();
+
+        _policy = policy;
+        for (const auto& origin : _policy.origins)
+            _originPatterns.push_back(g_pattern_spec_new(origin.c_str()));
+
+        RDKLOG_INFO("Policy for %s: mainFrameOnly=%d normalWorldOnly=%d origins=%zu", _extName.c_str(),
+            _policy.mainFrameOnly, _policy.normalWorldOnly, _policy.origins.size());
+    }
+
+    bool ClassDefinition::ShouldInject(const InjectionTarget& target) const
+    {
+        if (_policy.mainFrameOnly && !target.isMainFrame)
+            return false;
+
+        if (_policy.normalWorldOnly && !target.isNormalWorld)
+            return false;
+
+        if (_originPatterns.empty())
+            return true;
+
+        for (auto pattern : _originPatterns) {
+            if (g_pattern_match_string(pattern, target.origin.c_str()))
+                return true;
+        }
+        return false;
+    }
+
+    /* static */ void ClassDefinition::LoadPolicies(const char* path)
+    {
+        GKeyFile* keyFile = g_key_file_new();
+        if (!g_key_file_load_from_file(keyFile, path, G_KEY_FILE_NONE, nullptr)) {
+            RDKLOG_INFO("No class injection policies in %s", path);
+            g_key_file_free(keyFile);
+            return;
+        }
+
+        for (auto& it : getClassMap()) {
+            ClassDefinition& classDef = it.second;
+            const char* group = classDef.GetExtName().c_str();
+            if (!g_key_file_has_group(keyFile, group))
+                continue;
+
+            InjectionPolicy policy;
+            policy.mainFrameOnly = g_key_file_get_boolean(keyFile, group, "MainFrameOnly", nullptr);
+            policy.normalWorldOnly = g_key_file_get_boolean(keyFile, group, "NormalWorldOnly", nullptr);
+
+            gchar** origins = g_key_file_get_string_list(keyFile, group, "Origins", nullptr, nullptr);
+            for (gchar** origin = origins; origin && *origin; ++origin) {
+                if (**origin)
+                    policy.origins.emplace_back(*origin);
+            }
+            g_strfreev(origins);
+
+            classDef.SetPolicy(policy);
+        }
+
+        g_key_file_free(keyFile);
+    }
+
+    /* static */ bool ClassDefinition::NeedsOrigin()
+    {
+        for (auto& it : getClassMap()) {
+            if (!it.second._originPatterns.empty())
+                return true;
+        }
+        return false;
+    }
+
+    /* static */ bool ClassDefinition::ShouldInjectAny(const InjectionTarget& target)
+    {
+        for (auto& it : getClassMap()) {
+            if (it.second.ShouldInject(target))
+                return true;
+        }
+        return false;
+    }
+
+    void ClassDefinition::ResetJSClass()
+    {
+        if (_jsClass) {
+            JSClassRelease(_jsClass);
+            _jsClass = nullptr;
+        }
+    }
+
+    JSClassRef ClassDefinition::GetJSClass()
     {
-        auto functions = classDef.GetFunctions();
-        uint32_t functionCount = std::distance(functions.begin(), functions.end());
+        if (_jsClass)
+            return _jsClass;
 
         // We need an extra entry that we set to all zeroes, to signal end of data.
+        // JSClassCreate copies the table, so it doesn't need to outlive this call.
         std::vector<JSStaticFunction> staticFunctions;
-        staticFunctions.reserve(functionCount + 1);
+        staticFunctions.reserve(_customFunctions.size() + 1);
 
-        int index = 0;
-        for(auto function : functions) {
-            staticFunctions[index++] = function->BuildJSStaticFunction();
+        for (auto function : _customFunctions) {
+            staticFunctions.push_back(function->BuildJSStaticFunction());
         }
 
-        staticFunctions[functionCount] = { nullptr, nullptr, 0 };
+        staticFunctions.push_back({ nullptr, nullptr, 0 });
 
         JSClassDefinition jsClassDefinition = {
             0, // version
             kJSClassAttributeNone, //attributes
-            classDef.GetClassName().c_str(), // className
+            GetClassName().c_str(), // className
             0, // parentClass
             nullptr, // staticValues
             staticFunctions.data(), // staticFunctions
@@ -125,31 +228,39 @@ namespace JavaScript {
             nullptr, //convertToType
         };
 
-        JSClassRef jsClass = JSClassCreate(&jsClassDefinition);
-        JSValueRef jsObject = JSObjectMake(context, jsClass, nullptr);
-        JSClassRelease(jsClass);
+        _jsClass = JSClassCreate(&jsClassDefinition);
+        RDKLOG_INFO("Created JS class %s with %zu functions", GetClassName().c_str(), _customFunctions.size());
+
+        return _jsClass;
+    }
+
+    void ClassDefinition::InjectInJSWorld(ClassDefinition& classDef, JSGlobalContextRef context)
+    {
+        JSValueRef jsObject = JSObjectMake(context, classDef.GetJSClass(), nullptr);
 
         // @Zan: can we make extension name same as ClassName?
-        JSStringRef extensionString = JSStringCreateWithUTF8CString(classDef.GetExtName().c_str());
-        JSObjectSetProperty(context, JSContextGetGlobalObject(context), extensionString, jsObject,
+        if (!classDef._extNameString)
+            classDef._extNameString = JSStringCreateWithUTF8CString(classDef.GetExtName().c_str());
+
+        JSObjectSetProperty(context, JSContextGetGlobalObject(context), classDef._extNameString, jsObject,
             kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete, nullptr);
-        JSStringRelease(extensionString);
     }
 
-    void ClassDefinition::InjectJSClass(JSGlobalContextRef context)
+    void ClassDefinition::InjectJSClass(JSGlobalContextRef context, const InjectionTarget& target)
     {
         // Add JS classes to JS world.
         auto& classMap  = getClassMap();
         for (auto& it : classMap) {
             ClassDefinition* result = nullptr;
             result = &(it.second);
-            InjectInJSWorld(*result, context);
+            if (result->ShouldInject(target))
+                InjectInJSWorld(*result, context);
         }
     }
 
-    void injectJSClass(JSGlobalContextRef context)
+    void injectJSClass(JSGlobalContextRef context, const InjectionTarget& target)
     {
-        ClassDefinition::InjectJSClass(context);
+        ClassDefinition::InjectJSClass(context, target);
     }
 }
 }
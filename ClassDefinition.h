@@ -23,12 +23,37 @@
 
 #include "JavaScriptFunction.h"
 
+#include <glib.h>
+
 #include <vector>
 #include <map>
 
 namespace WPEFramework {
 namespace JavaScript {
 
+    // Frame and script world that are about to get classes injected.
+    struct InjectionTarget {
+        bool isMainFrame;
+        bool isNormalWorld;
+        // "scheme://host", with ":port" appended when the port is not the scheme's default,
+        // only filled in when ClassDefinition::NeedsOrigin() is true.
+        std::string origin;
+    };
+
+    // Where a class may be injected. Default policy allows every frame and world.
+    struct InjectionPolicy {
+        InjectionPolicy()
+            : mainFrameOnly(false)
+            , normalWorldOnly(false)
+        {
+        }
+
+        bool mainFrameOnly;
+        bool normalWorldOnly;
+        // Glob patterns matched against the frame origin, empty means any origin.
+        std::vector<std::string> origins;
+    };
+
     class ClassDefinition {
     private:
         ClassDefinition() = delete;
@@ -42,17 +67,34 @@ namespace JavaScript {
 
         // These are the only viable constructor, but only via the static creation method !!!
         ClassDefinition(const std::string& identifier);
-        ~ClassDefinition() {}
+        ~ClassDefinition();
 
     public:
         static ClassMap& getClassMap();
-        static void InjectJSClass(JSGlobalContextRef context);
+        static void InjectJSClass(JSGlobalContextRef context, const InjectionTarget& target);
         static void InjectInJSWorld(ClassDefinition& classDef, JSGlobalContextRef context);
         static ClassDefinition& Instance(const std::string& className);
 
+        // Loads policies from key file, one group per extension name, e.g.
+        // [thunder]
+        // MainFrameOnly=true
+        // NormalWorldOnly=true
+        // Origins=https://*.example.com;http://localhost;http://localhost:8080
+        // Origins are globs matched against the frame's origin, "scheme://host"
+        // with ":port" only for a non-default port: "http://localhost" does not
+        // match port 8080, "http://localhost:*" matches any explicit port.
+        static void LoadPolicies(const char* path);
+        // True if any class has an origin allow-list.
+        static bool NeedsOrigin();
+        // True if at least one class would be injected into the target.
+        static bool ShouldInjectAny(const InjectionTarget& target);
+
         void Add(const JavaScriptFunction* javaScriptFunction);
         void Remove(const JavaScriptFunction* javaScriptFunction);
 
+        void SetPolicy(const InjectionPolicy& policy);
+        bool ShouldInject(const InjectionTarget& target) const;
+
     private:
         const FunctionVector& GetFunctions()
         {
@@ -67,8 +109,20 @@ namespace JavaScript {
             return (_extName);
         }
 
+        // Returns JS class, creating it on first use. Contexts share the same class.
+        JSClassRef GetJSClass();
+        // Drops the cached JS class, so it gets rebuilt with current functions.
+        void ResetJSClass();
+
         FunctionVector _customFunctions;
 
+        // Cached JS class and extension name, valid until functions change.
+        JSClassRef _jsClass;
+        JSStringRef _extNameString;
+
+        InjectionPolicy _policy;
+        std::vector<GPatternSpec*> _originPatterns;
+
         // JavaScript class properties.
         std::string _className;
         std::string _extName;
@@ -78,7 +132,7 @@ namespace JavaScript {
         //static ClassMap _classes;
     };
 
-    void injectJSClass(JSGlobalContextRef context);
+    void injectJSClass(JSGlobalContextRef context, const InjectionTarget& target);
 }
 }
 #endif // __CUSTOMCLASS_H
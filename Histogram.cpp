@@ -0,0 +1,97 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+void Histogram::reset()
+{
+    std::fill(std::begin(m_buckets), std::end(m_buckets), 0);
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+/* static */ int Histogram::bucketFor(double value)
+{
+    if (!(value > 0))
+        return 0;
+    if (!std::isfinite(value))
+        return kBucketCount - 1;
+    int bucket = static_cast<int>(std::ceil(std::log2(value + 1) * 4));
+    return std::min(bucket, kBucketCount - 1);
+}
+
+/* static */ double Histogram::bucketUpperBound(int bucket)
+{
+    return std::exp2(bucket / 4.0) - 1;
+}
+
+void Histogram::add(double value)
+{
+    if (!std::isfinite(value))
+        return;
+    if (value < 0)
+        value = 0;
+
+    ++m_buckets[bucketFor(value)];
+    if (!m_count || value < m_min)
+        m_min = value;
+    if (!m_count || value > m_max)
+        m_max = value;
+    ++m_count;
+    m_sum += value;
+}
+
+double Histogram::percentile(double p) const
+{
+    if (!m_count)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::max(0.0, std::min(p, 100.0)) / 100.0 * m_count));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::max(m_min, std::min(m_max, bucketUpperBound(i)));
+    }
+    return m_max;
+}
+
+void Histogram::appendJSON(std::string& out) const
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+        "{\"count\":%llu,\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f}",
+        static_cast<unsigned long long>(m_count), min(), max(), mean(),
+        percentile(50), percentile(90), percentile(99));
+    out += buffer;
+}
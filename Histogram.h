@@ -0,0 +1,69 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * Fixed-size histogram of non-negative values (latencies, sizes).
+ * Buckets grow by a quarter power of two, so percentiles are within ~19%
+ * of the real value while the memory stays constant. Not thread safe.
+ */
+class Histogram
+{
+public:
+    Histogram();
+
+    // Negative values count as 0, NaN and infinities are ignored.
+    void add(double value);
+    void reset();
+
+    uint64_t count() const { return m_count; }
+    double sum() const { return m_sum; }
+    double min() const { return m_count ? m_min : 0; }
+    double max() const { return m_count ? m_max : 0; }
+    double mean() const { return m_count ? m_sum / m_count : 0; }
+
+    /**
+     * @param p Percentile in [0, 100].
+     * @return Upper bound of the bucket holding it, clamped to the observed range.
+     */
+    double percentile(double p) const;
+
+    /**
+     * Appends {"count":..,"min":..,"max":..,"mean":..,"p50":..,"p90":..,"p99":..}.
+     */
+    void appendJSON(std::string& out) const;
+
+private:
+    static const int kBucketCount = 128;
+
+    static int bucketFor(double value);
+    static double bucketUpperBound(int bucket);
+
+    uint64_t m_buckets[kBucketCount];
+    uint64_t m_count;
+    double m_sum;
+    double m_min;
+    double m_max;
+};
+
+#endif // HISTOGRAM_H
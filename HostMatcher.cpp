@@ -0,0 +1,99 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "HostMatcher.h"
+#include "logger.h"
+
+#include <algorithm>
+
+HostMatcher::~HostMatcher()
+{
+    clear();
+}
+
+void HostMatcher::add(const std::string& rule, Action action)
+{
+    if (rule.empty() || action == Action::None)
+        return;
+
+    std::string lowered = rule;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+
+    if (lowered.find_first_of("*?") != std::string::npos)
+    {
+        m_globs.push_back({ lowered, g_pattern_spec_new(lowered.c_str()), action });
+        return;
+    }
+
+    // Deny wins over allow for the same rule.
+    auto& table = lowered[0] == '.' ? m_suffixes : m_exact;
+    std::string key = lowered[0] == '.' ? lowered.substr(1) : lowered;
+    auto it = table.find(key);
+    if (it == table.end() || action == Action::Deny)
+        table[key] = action;
+}
+
+void HostMatcher::clear()
+{
+    for (auto& glob : m_globs)
+        g_pattern_spec_free(glob.pattern);
+    m_globs.clear();
+    m_exact.clear();
+    m_suffixes.clear();
+}
+
+bool HostMatcher::empty() const
+{
+    return m_exact.empty() && m_suffixes.empty() && m_globs.empty();
+}
+
+HostMatcher::Action HostMatcher::match(const std::string& host) const
+{
+    if (host.empty())
+        return Action::None;
+
+    auto it = m_exact.find(host);
+    if (it != m_exact.end())
+        return it->second;
+
+    // Walk label boundaries from the longest suffix to the shortest.
+    if (!m_suffixes.empty())
+    {
+        size_t pos = 0;
+        while (pos != std::string::npos)
+        {
+            it = m_suffixes.find(pos ? host.substr(pos) : host);
+            if (it != m_suffixes.end())
+                return it->second;
+            pos = host.find('.', pos);
+            if (pos != std::string::npos)
+                ++pos;
+        }
+    }
+
+    for (const auto& glob : m_globs)
+    {
+        if (g_pattern_match_string(glob.pattern, host.c_str()))
+        {
+            RDKLOG_TRACE("host [%s] matches [%s]", host.c_str(), glob.rule.c_str());
+            return glob.action;
+        }
+    }
+
+    return Action::None;
+}
@@ -0,0 +1,65 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef HOSTMATCHER_H
+#define HOSTMATCHER_H
+
+#include <glib.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Set of allow/deny host rules compiled for lookup in a handful of hash probes.
+ * Rules are written as:
+ *   "example.com"     exact host
+ *   ".example.com"    the host itself and any of its subdomains
+ *   "*.example.*"     glob (GPatternSpec), checked last in insertion order
+ * The most specific match wins: exact, then longest suffix, then first glob.
+ */
+class HostMatcher
+{
+public:
+    enum class Action { None, Allow, Deny };
+
+    HostMatcher() = default;
+    ~HostMatcher();
+    HostMatcher(const HostMatcher&) = delete;
+    HostMatcher& operator=(const HostMatcher&) = delete;
+
+    void add(const std::string& rule, Action action);
+    void clear();
+    bool empty() const;
+
+    Action match(const std::string& host) const;
+
+private:
+    struct Glob
+    {
+        std::string rule;
+        GPatternSpec* pattern;
+        Action action;
+    };
+
+    std::unordered_map<std::string, Action> m_exact;
+    std::unordered_map<std::string, Action> m_suffixes;
+    std::vector<Glob> m_globs;
+};
+
+#endif // HOSTMATCHER_H
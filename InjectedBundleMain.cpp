@@ -17,6 +17,7 @@
  * limitations under the License.
 */
 #include "BundleController.h"
+#include "ClassDefinition.h"
 
 #ifdef ENABLE_AVE
 #include "AVESupport.h"
@@ -73,6 +74,8 @@ extern "C" void WKBundleInitialize(WKBundleRef bundle, WKTypeRef initializationU
 
     JSBridge::initialize(bundle, initializationUserData);
 
+    WPEFramework::JavaScript::ClassDefinition::LoadPolicies("/etc/injectedbundle/classpolicy.conf");
+
 #ifdef ENABLE_AVE
     AVESupport::initialize();
 #endif
@@ -0,0 +1,114 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "JavaScriptAsyncFunctionType.h"
+#include "logger.h"
+
+namespace WPEFramework {
+namespace JavaScript {
+
+    Deferred::Deferred(JSGlobalContextRef context)
+        : _context(JSGlobalContextRetain(context))
+        , _resolve(nullptr)
+        , _reject(nullptr)
+    {
+    }
+
+    Deferred::~Deferred()
+    {
+        if (_resolve)
+            JSValueUnprotect(_context, _resolve);
+        if (_reject)
+            JSValueUnprotect(_context, _reject);
+        JSGlobalContextRelease(_context);
+    }
+
+    /* static */ JSValueRef Deferred::Executor(JSContextRef context, JSObjectRef function,
+        JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*)
+    {
+        Deferred* deferred = static_cast<Deferred*>(JSObjectGetPrivate(function));
+        if (deferred && argumentCount >= 2
+            && JSValueIsObject(context, arguments[0]) && JSValueIsObject(context, arguments[1])) {
+            deferred->_resolve = (JSObjectRef) arguments[0];
+            deferred->_reject = (JSObjectRef) arguments[1];
+            JSValueProtect(context, deferred->_resolve);
+            JSValueProtect(context, deferred->_reject);
+        }
+        return JSValueMakeUndefined(context);
+    }
+
+    // Class of the executor passed to the Promise constructor.
+    // It's called synchronously and picks up resolve and reject functions.
+    /* static */ JSClassRef Deferred::ExecutorClass()
+    {
+        static JSClassRef jsClass = [] {
+            JSClassDefinition definition = kJSClassDefinitionEmpty;
+            definition.className = "DeferredExecutor";
+            definition.callAsFunction = Executor;
+            return JSClassCreate(&definition);
+        }();
+        return jsClass;
+    }
+
+    /* static */ std::shared_ptr<Deferred> Deferred::Create(JSContextRef context, JSObjectRef& promise, JSValueRef* exception)
+    {
+        JSStringRef promiseString = JSStringCreateWithUTF8CString("Promise");
+        JSValueRef constructor = JSObjectGetProperty(context, JSContextGetGlobalObject(context), promiseString, exception);
+        JSStringRelease(promiseString);
+
+        if (!constructor || !JSValueIsObject(context, constructor)) {
+            RDKLOG_ERROR("Promise constructor is not available");
+            return nullptr;
+        }
+
+        std::shared_ptr<Deferred> deferred(new Deferred(JSContextGetGlobalContext(context)));
+
+        JSObjectRef executor = JSObjectMake(context, ExecutorClass(), deferred.get());
+        JSValueRef arguments[] = { executor };
+        promise = JSObjectCallAsConstructor(context, (JSObjectRef) constructor, 1, arguments, exception);
+        JSObjectSetPrivate(executor, nullptr);
+
+        if (!promise || !deferred->_resolve) {
+            RDKLOG_ERROR("Could not create Promise");
+            return nullptr;
+        }
+
+        return deferred;
+    }
+
+    void Deferred::Resolve(JSValueRef value)
+    {
+        if (_resolve)
+            (void) JSObjectCallAsFunction(_context, _resolve, nullptr, 1, &value, nullptr);
+    }
+
+    void Deferred::Reject(const std::string& message)
+    {
+        if (!_reject)
+            return;
+
+        JSStringRef messageString = JSStringCreateWithUTF8CString(message.c_str());
+        JSValueRef argument = JSValueMakeString(_context, messageString);
+        JSStringRelease(messageString);
+
+        JSValueRef error = JSObjectMakeError(_context, 1, &argument, nullptr);
+        (void) JSObjectCallAsFunction(_context, _reject, nullptr, 1, &error, nullptr);
+    }
+}
+}
@@ -0,0 +1,189 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JAVASCRIPTASYNCFUNCTIONTYPE_H
+#define __JAVASCRIPTASYNCFUNCTIONTYPE_H
+
+#include "JavaScriptTypedFunctionType.h"
+#include "WorkerPool.h"
+
+#include <exception>
+#include <functional>
+
+namespace WPEFramework {
+
+namespace JavaScript {
+
+    // Promise waiting for a result from a worker thread.
+    // Must be created, settled and destroyed on the main thread.
+    class Deferred {
+    public:
+        // Creates new Promise in the context, sets it to 'promise'.
+        static std::shared_ptr<Deferred> Create(JSContextRef context, JSObjectRef& promise, JSValueRef* exception);
+
+        ~Deferred();
+
+        JSContextRef Context() const
+        {
+            return _context;
+        }
+
+        void Resolve(JSValueRef value);
+        void Reject(const std::string& message);
+
+    private:
+        Deferred(JSGlobalContextRef context);
+        Deferred(const Deferred&) = delete;
+        Deferred& operator=(const Deferred&) = delete;
+
+        static JSClassRef ExecutorClass();
+        static JSValueRef Executor(JSContextRef context, JSObjectRef function,
+            JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*);
+
+        JSGlobalContextRef _context;
+        JSObjectRef _resolve;
+        JSObjectRef _reject;
+    };
+
+    namespace Marshalling {
+
+        // Result of the work, carried from worker to main thread.
+        template <typename Result>
+        struct AsyncResult {
+            static_assert(!std::is_same<Result, JSValueRef>::value, "JS values can't be created off the main thread");
+
+            void Run(const std::function<Result()>& work)
+            {
+                try {
+                    value = work();
+                } catch (const std::exception& e) {
+                    failed = true;
+                    error = e.what();
+                }
+            }
+            void Settle(Deferred& deferred)
+            {
+                if (failed)
+                    deferred.Reject(error);
+                else
+                    deferred.Resolve(JSValueConverter<Result>::ToJS(deferred.Context(), value));
+            }
+
+            Result value {};
+            bool failed = false;
+            std::string error;
+        };
+
+        template <>
+        struct AsyncResult<void> {
+            void Run(const std::function<void()>& work)
+            {
+                try {
+                    work();
+                } catch (const std::exception& e) {
+                    failed = true;
+                    error = e.what();
+                }
+            }
+            void Settle(Deferred& deferred)
+            {
+                if (failed)
+                    deferred.Reject(error);
+                else
+                    deferred.Resolve(JSValueMakeUndefined(deferred.Context()));
+            }
+
+            bool failed = false;
+            std::string error;
+        };
+
+        // Runs work on the worker pool and returns a Promise for its result.
+        template <typename Result>
+        JSValueRef Schedule(JSContextRef context, std::function<Result()> work, JSValueRef* exception)
+        {
+            JSObjectRef promise = nullptr;
+            std::shared_ptr<Deferred> deferred = Deferred::Create(context, promise, exception);
+            if (!deferred)
+                return nullptr;
+
+            auto result = std::make_shared<AsyncResult<Result>>();
+            ::WorkerPool::run(
+                [work, result]() { result->Run(work); },
+                [deferred, result]() { result->Settle(*deferred); });
+
+            return promise;
+        }
+
+    } // namespace Marshalling
+
+    // Like TypedJavaScriptFunctionType, but the call completes asynchronously.
+    // Handler's Call() runs on the main thread with converted arguments and returns
+    // the work, e.g. "std::function<std::string()> Call(const std::string& name)".
+    // The work runs on a bundle worker thread, so it must not touch JS or WebKit objects.
+    // JavaScript gets a Promise, settled on the main thread with the work's result.
+    template <typename ActualJavaScriptFunction>
+    class AsyncJavaScriptFunctionType : public JavaScriptFunction {
+    public:
+        // Constructor, also registers to ClassDefinition.
+        AsyncJavaScriptFunctionType(const std::string& jsClassName, const std::string& jsFunName, bool shouldNotEnum = false)
+            : JavaScriptFunction(jsFunName, function, shouldNotEnum)
+            , JsClassName(jsClassName)
+        {
+            FunctionName() = jsClassName + "." + jsFunName;
+            ClassDefinition::Instance(JsClassName).Add(this);
+        }
+
+        // Destructor, also unregisters function.
+        ~AsyncJavaScriptFunctionType()
+        {
+            ClassDefinition::Instance(JsClassName).Remove(this);
+        }
+
+    private:
+        typedef decltype(&ActualJavaScriptFunction::Call) Method;
+        typedef typename Marshalling::Signature<Method>::Result Work;
+
+        // Callback function.
+        static JSValueRef function(JSContextRef context, JSObjectRef,
+            JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception)
+        {
+            return Marshalling::Signature<Method>::Call(Handler, &ActualJavaScriptFunction::Call, FunctionName(),
+                context, argumentCount, arguments, exception, [context, exception](auto&& call) {
+                    Work work = call();
+                    return Marshalling::Schedule<typename Work::result_type>(context, std::move(work), exception);
+                });
+        }
+
+        // Name used in error messages.
+        static std::string& FunctionName()
+        {
+            static std::string name;
+            return name;
+        }
+
+        static ActualJavaScriptFunction Handler;
+        std::string JsClassName;
+    };
+
+    template <typename ActualJavaScriptFunction>
+    ActualJavaScriptFunction AsyncJavaScriptFunctionType<ActualJavaScriptFunction>::Handler;
+}
+}
+
+#endif // __JAVASCRIPTASYNCFUNCTIONTYPE_H
@@ -0,0 +1,356 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __JAVASCRIPTTYPEDFUNCTIONTYPE_H
+#define __JAVASCRIPTTYPEDFUNCTIONTYPE_H
+
+#include "ClassDefinition.h"
+#include "JavaScriptFunction.h"
+#include "utils.h"
+
+#include <JavaScriptCore/JSContextRef.h>
+#include <JavaScriptCore/JSValueRef.h>
+
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace WPEFramework {
+
+namespace JavaScript {
+
+    // Conversion of a single argument or return value between JS and C++.
+    // Specialized for bool, arithmetic types, std::string and JSValueRef.
+    template <typename T, typename Enable = void>
+    struct JSValueConverter;
+
+    template <>
+    struct JSValueConverter<bool> {
+        static bool FromJS(JSContextRef context, JSValueRef value, bool& result)
+        {
+            if (!JSValueIsBoolean(context, value))
+                return false;
+            result = JSValueToBoolean(context, value);
+            return true;
+        }
+        static JSValueRef ToJS(JSContextRef context, bool value)
+        {
+            return JSValueMakeBoolean(context, value);
+        }
+        static const char* Name() { return "a boolean"; }
+    };
+
+    template <typename T>
+    struct JSValueConverter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+        static bool FromJS(JSContextRef context, JSValueRef value, T& result)
+        {
+            if (!JSValueIsNumber(context, value))
+                return false;
+            result = static_cast<T>(JSValueToNumber(context, value, nullptr));
+            return true;
+        }
+        static JSValueRef ToJS(JSContextRef context, T value)
+        {
+            return JSValueMakeNumber(context, static_cast<double>(value));
+        }
+        static const char* Name() { return "a number"; }
+    };
+
+    // Integers only accept finite, integral numbers within the range of T,
+    // anything else would be undefined behaviour in the conversion.
+    template <typename T>
+    struct JSValueConverter<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+        static bool FromJS(JSContextRef context, JSValueRef value, T& result)
+        {
+            if (!JSValueIsNumber(context, value))
+                return false;
+            double number = JSValueToNumber(context, value, nullptr);
+            if (!std::isfinite(number) || std::trunc(number) != number)
+                return false;
+            // Bounds as doubles: min is a power of two (or 0) and exact, max + 1 is too.
+            const double min = static_cast<double>(std::numeric_limits<T>::min());
+            const double maxPlusOne = (static_cast<double>(std::numeric_limits<T>::max() / 2 + 1)) * 2.0;
+            if (number < min || number >= maxPlusOne)
+                return false;
+            result = static_cast<T>(number);
+            return true;
+        }
+        static JSValueRef ToJS(JSContextRef context, T value)
+        {
+            return JSValueMakeNumber(context, static_cast<double>(value));
+        }
+        static std::string Name()
+        {
+            return "an integer from " + std::to_string(std::numeric_limits<T>::min())
+                + " to " + std::to_string(std::numeric_limits<T>::max());
+        }
+    };
+
+    template <>
+    struct JSValueConverter<std::string> {
+        static bool FromJS(JSContextRef context, JSValueRef value, std::string& result)
+        {
+            if (!JSValueIsString(context, value))
+                return false;
+
+            JSStringRef string = JSValueToStringCopy(context, value, nullptr);
+            if (!string)
+                return false;
+
+            size_t size = JSStringGetMaximumUTF8CStringSize(string);
+            std::unique_ptr<char[]> buffer(new char[size]);
+            size_t length = JSStringGetUTF8CString(string, buffer.get(), size);
+            JSStringRelease(string);
+
+            result.assign(buffer.get(), length ? length - 1 : 0);
+            return true;
+        }
+        static JSValueRef ToJS(JSContextRef context, const std::string& value)
+        {
+            JSStringRef string = JSStringCreateWithUTF8CString(value.c_str());
+            JSValueRef result = JSValueMakeString(context, string);
+            JSStringRelease(string);
+            return result;
+        }
+        static const char* Name() { return "a string"; }
+    };
+
+    // Raw value, for handlers that inspect an argument themselves.
+    template <>
+    struct JSValueConverter<JSValueRef> {
+        static bool FromJS(JSContextRef, JSValueRef value, JSValueRef& result)
+        {
+            result = value;
+            return true;
+        }
+        static JSValueRef ToJS(JSContextRef context, JSValueRef value)
+        {
+            return value ? value : JSValueMakeUndefined(context);
+        }
+        static const char* Name() { return "any value"; }
+    };
+
+    namespace Marshalling {
+
+        inline JSValueRef MakeTypeError(JSContextRef context, const std::string& message)
+        {
+            JSRetainPtr<JSStringRef> string = adopt(JSStringCreateWithUTF8CString(message.c_str()));
+            return Utils::makeError(context, "TypeError", string.get());
+        }
+
+        template <typename T>
+        bool ConvertArgument(JSContextRef context, const std::string& functionName, size_t index,
+            JSValueRef value, T& result, JSValueRef* exception)
+        {
+            if (JSValueConverter<T>::FromJS(context, value, result))
+                return true;
+
+            if (exception && !*exception) {
+                *exception = MakeTypeError(context, functionName + ": argument " + std::to_string(index + 1)
+                    + " must be " + JSValueConverter<T>::Name());
+            }
+            return false;
+        }
+
+        // Calls the handler and converts its result, void becomes undefined.
+        template <typename Result>
+        struct Returner {
+            template <typename Call>
+            static JSValueRef Run(JSContextRef context, Call&& call)
+            {
+                return JSValueConverter<typename std::decay<Result>::type>::ToJS(context, call());
+            }
+        };
+
+        template <>
+        struct Returner<void> {
+            template <typename Call>
+            static JSValueRef Run(JSContextRef context, Call&& call)
+            {
+                call();
+                return JSValueMakeUndefined(context);
+            }
+        };
+
+        // Runs the handler, prepending the calling context when it asks for one.
+        template <bool PassContext>
+        struct Caller {
+            template <typename Handler, typename Method, typename Values, size_t... Index>
+            static decltype(auto) Run(Handler& handler, Method method, JSContextRef, Values& values, std::index_sequence<Index...>)
+            {
+                return (handler.*method)(std::get<Index>(values)...);
+            }
+        };
+
+        template <>
+        struct Caller<true> {
+            template <typename Handler, typename Method, typename Values, size_t... Index>
+            static decltype(auto) Run(Handler& handler, Method method, JSContextRef context, Values& values, std::index_sequence<Index...>)
+            {
+                return (handler.*method)(context, std::get<Index>(values)...);
+            }
+        };
+
+        // Checks and converts the arguments, then passes a callable that runs
+        // the handler to finish(), which produces the value returned to JS.
+        template <bool PassContext, typename Handler, typename Method, typename... Args, typename Finish, size_t... Index>
+        JSValueRef Invoke(Handler& handler, Method method, const std::string& functionName, JSContextRef context,
+            size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception, Finish&& finish,
+            std::index_sequence<Index...>)
+        {
+            if (argumentCount != sizeof...(Args)) {
+                if (exception) {
+                    *exception = MakeTypeError(context, functionName + " takes " + std::to_string(sizeof...(Args))
+                        + " argument(s), " + std::to_string(argumentCount) + " given");
+                }
+                return nullptr;
+            }
+
+            std::tuple<typename std::decay<Args>::type...> values;
+            bool converted = true;
+            (void) std::initializer_list<int> {
+                (converted = converted && ConvertArgument(context, functionName, Index, arguments[Index], std::get<Index>(values), exception), 0)...
+            };
+            (void) arguments;
+
+            if (!converted)
+                return nullptr;
+
+            return finish([&]() -> decltype(auto) {
+                return Caller<PassContext>::Run(handler, method, context, values, std::index_sequence<Index...>());
+            });
+        }
+
+        template <typename Method>
+        struct Signature;
+
+        template <typename Handler, typename R, typename... Args>
+        struct Signature<R (Handler::*)(Args...)> {
+            typedef R Result;
+
+            template <typename Method, typename Finish>
+            static JSValueRef Call(Handler& handler, Method method, const std::string& functionName, JSContextRef context,
+                size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception, Finish&& finish)
+            {
+                return Invoke<false, Handler, Method, Args...>(handler, method, functionName, context,
+                    argumentCount, arguments, exception, std::forward<Finish>(finish), std::index_sequence_for<Args...>());
+            }
+        };
+
+        template <typename Handler, typename R, typename... Args>
+        struct Signature<R (Handler::*)(Args...) const> {
+            typedef R Result;
+
+            template <typename Method, typename Finish>
+            static JSValueRef Call(Handler& handler, Method method, const std::string& functionName, JSContextRef context,
+                size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception, Finish&& finish)
+            {
+                return Invoke<false, Handler, Method, Args...>(handler, method, functionName, context,
+                    argumentCount, arguments, exception, std::forward<Finish>(finish), std::index_sequence_for<Args...>());
+            }
+        };
+
+        // A leading JSContextRef parameter receives the calling context, it is not taken from JS.
+        template <typename Handler, typename R, typename... Args>
+        struct Signature<R (Handler::*)(JSContextRef, Args...)> {
+            typedef R Result;
+
+            template <typename Method, typename Finish>
+            static JSValueRef Call(Handler& handler, Method method, const std::string& functionName, JSContextRef context,
+                size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception, Finish&& finish)
+            {
+                return Invoke<true, Handler, Method, Args...>(handler, method, functionName, context,
+                    argumentCount, arguments, exception, std::forward<Finish>(finish), std::index_sequence_for<Args...>());
+            }
+        };
+
+        template <typename Handler, typename R, typename... Args>
+        struct Signature<R (Handler::*)(JSContextRef, Args...) const> {
+            typedef R Result;
+
+            template <typename Method, typename Finish>
+            static JSValueRef Call(Handler& handler, Method method, const std::string& functionName, JSContextRef context,
+                size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception, Finish&& finish)
+            {
+                return Invoke<true, Handler, Method, Args...>(handler, method, functionName, context,
+                    argumentCount, arguments, exception, std::forward<Finish>(finish), std::index_sequence_for<Args...>());
+            }
+        };
+
+    } // namespace Marshalling
+
+    // Like JavaScriptFunctionType, but the handler declares a typed
+    // Call() member, e.g. "std::string Call(int count, const std::string& name)".
+    // Call() may take the calling JSContextRef as its first parameter.
+    // Argument count and types are checked against that signature and a TypeError
+    // is thrown to JavaScript on mismatch.
+    template <typename ActualJavaScriptFunction>
+    class TypedJavaScriptFunctionType : public JavaScriptFunction {
+    public:
+        // Constructor, also registers to ClassDefinition.
+        TypedJavaScriptFunctionType(const std::string& jsClassName, const std::string& jsFunName, bool shouldNotEnum = false)
+            : JavaScriptFunction(jsFunName, function, shouldNotEnum)
+            , JsClassName(jsClassName)
+        {
+            FunctionName() = jsClassName + "." + jsFunName;
+            ClassDefinition::Instance(JsClassName).Add(this);
+        }
+
+        // Destructor, also unregisters function.
+        ~TypedJavaScriptFunctionType()
+        {
+            ClassDefinition::Instance(JsClassName).Remove(this);
+        }
+
+    private:
+        typedef decltype(&ActualJavaScriptFunction::Call) Method;
+
+        // Callback function.
+        static JSValueRef function(JSContextRef context, JSObjectRef,
+            JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef* exception)
+        {
+            typedef typename Marshalling::Signature<Method>::Result Result;
+            return Marshalling::Signature<Method>::Call(Handler, &ActualJavaScriptFunction::Call, FunctionName(),
+                context, argumentCount, arguments, exception, [context](auto&& call) {
+                    return Marshalling::Returner<Result>::Run(context, call);
+                });
+        }
+
+        // Name used in error messages.
+        static std::string& FunctionName()
+        {
+            static std::string name;
+            return name;
+        }
+
+        static ActualJavaScriptFunction Handler;
+        std::string JsClassName;
+    };
+
+    template <typename ActualJavaScriptFunction>
+    ActualJavaScriptFunction TypedJavaScriptFunctionType<ActualJavaScriptFunction>::Handler;
+}
+}
+
+#endif // __JAVASCRIPTTYPEDFUNCTIONTYPE_H
@@ -0,0 +1,157 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "LazyBinding.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <JavaScriptCore/JSContextRef.h>
+#include <JavaScriptCore/JSObjectRef.h>
+#include <JavaScriptCore/JSStringRef.h>
+#include <JavaScriptCore/JSRetainPtr.h>
+
+#include <glib.h>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+
+namespace LazyBinding
+{
+
+namespace
+{
+
+struct Binding
+{
+    Loader load;
+    std::vector<std::string> globals;
+    bool loaded;
+};
+
+/**
+ * Private data of a getter: the shared binding and the global it stands for.
+ */
+struct Getter
+{
+    std::shared_ptr<Binding> binding;
+    std::string name;
+};
+
+JSValueRef onFirstAccess(JSContextRef ctx, JSObjectRef function, JSObjectRef,
+    size_t, const JSValueRef*, JSValueRef* exc)
+{
+    const Getter* getter = static_cast<const Getter*>(JSObjectGetPrivate(function));
+    JSObjectRef windowObject = JSContextGetGlobalObject(ctx);
+
+    Binding& binding = *getter->binding;
+    if (!binding.loaded)
+    {
+        binding.loaded = true;
+
+        // The getters have no setters, so they must be gone before the bindings define the globals.
+        for (const auto& name : binding.globals)
+        {
+            JSRetainPtr<JSStringRef> nameStr = adopt(JSStringCreateWithUTF8CString(name.c_str()));
+            (void) JSObjectDeleteProperty(ctx, windowObject, nameStr.get(), nullptr);
+        }
+
+        RDKLOG_INFO("First access to %s, loading bindings", getter->name.c_str());
+        binding.load(JSContextGetGlobalContext(ctx));
+    }
+
+    JSRetainPtr<JSStringRef> nameStr = adopt(JSStringCreateWithUTF8CString(getter->name.c_str()));
+    return JSObjectGetProperty(ctx, windowObject, nameStr.get(), exc);
+}
+
+void finalizeGetter(JSObjectRef object)
+{
+    delete static_cast<Getter*>(JSObjectGetPrivate(object));
+}
+
+JSClassRef getterClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "LazyBindingGetter";
+        definition.callAsFunction = onFirstAccess;
+        definition.finalize = finalizeGetter;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+} // namespace
+
+bool enabled()
+{
+    static bool lazy = [] {
+        const char* s = getenv("ENABLE_LAZY_MEDIA_BINDINGS");
+        return s && strcmp(s, "1") == 0;
+    }();
+    return lazy;
+}
+
+std::vector<std::string> globalsFromEnv(const char* name, const char* defaultValue)
+{
+    const char* s = getenv(name);
+    gchar** names = g_strsplit(s ? s : defaultValue, ",", -1);
+
+    std::vector<std::string> globals;
+    for (gchar** it = names; it && *it; ++it)
+    {
+        g_strstrip(*it);
+        if (**it)
+            globals.emplace_back(*it);
+    }
+    g_strfreev(names);
+    return globals;
+}
+
+bool install(JSGlobalContextRef context, const std::vector<std::string>& globals, Loader load)
+{
+    if (globals.empty())
+        return false;
+
+    auto binding = std::make_shared<Binding>();
+    binding->load = load;
+    binding->globals = globals;
+    binding->loaded = false;
+
+    // Called right after commit, no page script has replaced Object yet.
+    for (const auto& name : globals)
+    {
+        JSObjectRef getter = JSObjectMake(context, getterClass(), new Getter { binding, name });
+        if (!Utils::defineLazyGetter(context, name.c_str(), getter))
+        {
+            RDKLOG_ERROR("Could not define lazy %s", name.c_str());
+            JSObjectRef windowObject = JSContextGetGlobalObject(context);
+            for (const auto& defined : globals)
+            {
+                if (defined == name)
+                    break;
+                JSRetainPtr<JSStringRef> definedStr = adopt(JSStringCreateWithUTF8CString(defined.c_str()));
+                (void) JSObjectDeleteProperty(context, windowObject, definedStr.get(), nullptr);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace LazyBinding
@@ -0,0 +1,51 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef LAZYBINDING_H
+#define LAZYBINDING_H
+
+#include <JavaScriptCore/JSBase.h>
+
+#include <string>
+#include <vector>
+
+namespace LazyBinding
+{
+
+typedef void (*Loader)(JSGlobalContextRef context);
+
+/**
+ * Returns true if media bindings should be loaded on first access (ENABLE_LAZY_MEDIA_BINDINGS=1).
+ */
+bool enabled();
+
+/**
+ * Reads a comma separated list of global names from an environment variable.
+ */
+std::vector<std::string> globalsFromEnv(const char* name, const char* defaultValue);
+
+/**
+ * Defines getters for globals on the window object. The first read of any of
+ * them removes all the getters, runs the loader and returns the real property.
+ * @return false if getters could not be defined, the caller should load eagerly.
+ */
+bool install(JSGlobalContextRef context, const std::vector<std::string>& globals, Loader load);
+
+};
+
+#endif // LAZYBINDING_H
@@ -0,0 +1,171 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "LogRing.h"
+#include "LogRingFormat.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace RDK
+{
+namespace LogRing
+{
+
+namespace
+{
+
+using namespace LogRingFormat;
+
+LogRingFormat::Header* gHeader = nullptr;
+char* gData = nullptr;
+uint64_t gCapacity = 0;
+
+void copyIn(uint64_t position, const char* data, size_t size)
+{
+    size_t offset = position % gCapacity;
+    size_t first = std::min<uint64_t>(size, gCapacity - offset);
+    memcpy(gData + offset, data, first);
+    memcpy(gData, data + first, size - first);
+}
+
+bool hasValidHeader(int fd)
+{
+    Header header;
+    return pread(fd, &header, sizeof(header), 0) == sizeof(header)
+        && !memcmp(header.magic, kMagic, sizeof(header.magic));
+}
+
+void savePrevious(int fd, const std::string& path)
+{
+    int saved = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (saved < 0)
+        return;
+
+    char buffer[4096];
+    off_t offset = 0;
+    ssize_t length;
+    while ((length = pread(fd, buffer, sizeof(buffer), offset)) > 0)
+    {
+        if (::write(saved, buffer, length) != length)
+            break;
+        offset += length;
+    }
+    close(saved);
+}
+
+} // namespace
+
+void init()
+{
+    const char* path = getenv("RDKBROWSER2_LOG_RING");
+    if (!path || !*path || gHeader)
+        return;
+
+    size_t capacity = 512 * 1024;
+    const char* capacityKB = getenv("RDKBROWSER2_LOG_RING_KB");
+    if (capacityKB && atoi(capacityKB) > 0)
+        capacity = std::max(atoi(capacityKB), 4) * 1024;
+
+    // The descriptor is never closed, it holds the lock for as long as the ring is in use.
+    std::string ringPath = path;
+    int fd = openExclusiveLogFile(ringPath, O_RDWR);
+    if (fd < 0)
+    {
+        RDK::log(ERROR_LEVEL, __func__, __FILE__, __LINE__, 0,
+            "Cannot open log ring %s: %s", ringPath.c_str(), strerror(errno));
+        return;
+    }
+
+    // Keep what the previous run left behind, it is the reason the ring exists.
+    // Copied rather than renamed, so the locked file stays the current ring.
+    if (hasValidHeader(fd))
+        savePrevious(fd, ringPath + ".prev");
+
+    if (ftruncate(fd, 0) < 0 || ftruncate(fd, sizeof(Header) + capacity) < 0)
+    {
+        RDK::log(ERROR_LEVEL, __func__, __FILE__, __LINE__, 0,
+            "Cannot create log ring %s: %s", ringPath.c_str(), strerror(errno));
+        close(fd);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(Header) + capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        RDK::log(ERROR_LEVEL, __func__, __FILE__, __LINE__, 0,
+            "Cannot map log ring %s: %s", ringPath.c_str(), strerror(errno));
+        close(fd);
+        return;
+    }
+
+    // Never unmapped, the kernel writes the pages back after the process is gone.
+    Header* header = static_cast<Header*>(mapping);
+    header->byteOrder = kByteOrderMark;
+    header->headerSize = sizeof(Header);
+    header->capacity = capacity;
+    header->cursor = 0;
+    memcpy(header->magic, kMagic, sizeof(header->magic));
+
+    gData = static_cast<char*>(mapping) + sizeof(Header);
+    gCapacity = capacity;
+    __atomic_store_n(&gHeader, header, __ATOMIC_RELEASE);
+}
+
+void write(LogLevel level,
+    const struct timespec& spec,
+    const char* func,
+    const char* file,
+    int line,
+    const char* message)
+{
+    Header* header = __atomic_load_n(&gHeader, __ATOMIC_ACQUIRE);
+    if (!header)
+        return;
+
+    const char* levelMap[] = {"Fatal", "Error", "Warning", "Info", "Verbose", "Trace"};
+    char prefix[256];
+    int prefixLength = snprintf(prefix, sizeof(prefix), "%ld.%03ld [%s] %s:%s:%d ",
+        static_cast<long>(spec.tv_sec),
+        static_cast<long>(spec.tv_nsec / 1000000),
+        levelMap[static_cast<int>(level)],
+        func, basename(file), line);
+    if (prefixLength < 0)
+        return;
+    prefixLength = std::min<int>(prefixLength, sizeof(prefix) - 1);
+
+    size_t messageLength = std::min<size_t>(strlen(message), gCapacity / 4);
+    size_t size = prefixLength + messageLength + 1;
+
+    // Concurrent writers get disjoint ranges, a line is never torn by another thread.
+    uint64_t position = __atomic_fetch_add(&header->cursor, size, __ATOMIC_RELAXED);
+    copyIn(position, prefix, prefixLength);
+    copyIn(position + prefixLength, message, messageLength);
+    copyIn(position + prefixLength + messageLength, "\n", 1);
+}
+
+} // namespace LogRing
+} // namespace RDK
@@ -0,0 +1,62 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RDK_LOG_RING_H
+#define RDK_LOG_RING_H
+
+#include "logger.h"
+
+#include <ctime>
+
+namespace RDK
+{
+
+/**
+ * Copy of the text log kept in a fixed-size memory-mapped circular file,
+ * enabled with RDKBROWSER2_LOG_RING=<file>. Writing a line is a cursor
+ * increment and a memcpy. The pages belong to the kernel's page cache, so
+ * the last lines survive a crash of the process and can be read back with
+ * tools/LogRingDump. The ring of the previous run is kept as <file>.prev.
+ * Each process needs a ring of its own: "%p" in the name is replaced by the
+ * process id, and a process that finds the file in use by another one
+ * writes to <file>.<pid> instead.
+ * Messages that go to the binary log (RDKBROWSER2_BINARY_LOG) are not
+ * formatted on the device and don't appear in the ring.
+ */
+namespace LogRing
+{
+
+/**
+ * @brief Map the file named by RDKBROWSER2_LOG_RING, called by logger_init()
+ */
+void init();
+
+/**
+ * @brief Append a log line to the ring, does nothing if it is not enabled
+ */
+void write(LogLevel level,
+    const struct timespec& spec,
+    const char* func,
+    const char* file,
+    int line,
+    const char* message);
+
+} // namespace LogRing
+} // namespace RDK
+
+#endif // RDK_LOG_RING_H
@@ -0,0 +1,54 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RDK_LOG_RING_FORMAT_H
+#define RDK_LOG_RING_FORMAT_H
+
+#include <cstdint>
+
+/**
+ * Layout of the memory-mapped log ring, shared by the logger and
+ * tools/LogRingDump. Values are stored in the byte order of the device.
+ *
+ * file := Header, capacity bytes of text lines
+ *
+ * cursor counts every byte ever written, the next line starts at
+ * cursor % capacity. Each line is
+ * "<seconds>.<milliseconds> [<Level>] <func>:<file>:<line> <message>\n".
+ */
+namespace RDK
+{
+namespace LogRingFormat
+{
+
+const char kMagic[8] = {'R', 'D', 'K', 'R', 'I', 'N', 'G', '1'};
+const uint32_t kByteOrderMark = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t headerSize;
+    uint64_t capacity;
+    uint64_t cursor; // updated with atomic builtins
+};
+
+} // namespace LogRingFormat
+} // namespace RDK
+
+#endif // RDK_LOG_RING_FORMAT_H
@@ -0,0 +1,240 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "MemoryPressurePolicy.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <WebKit/WKArray.h>
+#include <WebKit/WKBundlePagePrivate.h>
+#include <WebKit/WKNumber.h>
+#include <WebKit/WKRetainPtr.h>
+
+#include <glib.h>
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string>
+
+namespace MemoryPressurePolicy
+{
+
+namespace
+{
+
+enum ResumeReason
+{
+    ResumedOnFirstFrame = 0,
+    ResumedOnFailure,
+    ResumedOnTimeout,
+    ResumeReasonCount
+};
+
+const char* const kResumeReasonNames[ResumeReasonCount] = { "firstFrame", "failure", "timeout" };
+
+guint envMs(const char* name, guint defaultValue)
+{
+    const char* s = getenv(name);
+    return s ? static_cast<guint>(std::max(atoi(s), 0)) : defaultValue;
+}
+
+struct Policy
+{
+    Policy()
+        : maxHoldMs(envMs("WPE_TUNE_MAX_HOLD_MS", 20000))
+        , minHoldMs(envMs("WPE_TUNE_MIN_HOLD_MS", 0))
+        , settleMs(envMs("WPE_TUNE_SETTLE_MS", 500))
+    {
+        RDKLOG_INFO("Tune memory pressure policy: max hold %u ms, min hold %u ms, settle %u ms",
+            maxHoldMs, minHoldMs, settleMs);
+    }
+
+    // Hard limit of a suspension, the old fixed window.
+    guint maxHoldMs;
+    // Suspension is never shorter than this, even if the tune fails early.
+    guint minHoldMs;
+    // Delay after first frame, the player still allocates right after it.
+    guint settleMs;
+
+    bool suspended { false };
+    int64_t suspendedAt { 0 };
+    guint maxHoldTag { 0 };
+    guint resumeTag { 0 };
+
+    uint64_t suspensions { 0 };
+    uint64_t resumes[ResumeReasonCount] { };
+    int64_t totalSuspendedUs { 0 };
+    int64_t longestSuspendedUs { 0 };
+};
+
+Policy& policy()
+{
+    static Policy& policy = *new Policy();
+    return policy;
+}
+
+void cancelTimer(guint& tag)
+{
+    if (tag)
+    {
+        g_source_remove(tag);
+        tag = 0;
+    }
+}
+
+void resume(ResumeReason reason)
+{
+    Policy& p = policy();
+    cancelTimer(p.maxHoldTag);
+    cancelTimer(p.resumeTag);
+    if (!p.suspended)
+        return;
+
+    int64_t heldUs = g_get_monotonic_time() - p.suspendedAt;
+    p.suspended = false;
+    p.totalSuspendedUs += heldUs;
+    p.longestSuspendedUs = std::max(p.longestSuspendedUs, heldUs);
+    ++p.resumes[reason];
+
+    WKBundleMemoryPressureHandlerStart();
+    RDKLOG_INFO("Memory pressure handling resumed on %s after %lld ms",
+        kResumeReasonNames[reason], static_cast<long long>(heldUs / 1000));
+}
+
+// Resumes once the suspension is at least delayMs old and minHoldMs long.
+void scheduleResume(ResumeReason reason, guint delayMs)
+{
+    Policy& p = policy();
+    if (!p.suspended)
+        return;
+
+    int64_t heldMs = (g_get_monotonic_time() - p.suspendedAt) / 1000;
+    int64_t waitMs = std::max<int64_t>(delayMs, static_cast<int64_t>(p.minHoldMs) - heldMs);
+    if (waitMs <= 0)
+    {
+        resume(reason);
+        return;
+    }
+
+    cancelTimer(p.resumeTag);
+    p.resumeTag = g_timeout_add(static_cast<guint>(waitMs), [](gpointer data) -> gboolean {
+        policy().resumeTag = 0;
+        resume(static_cast<ResumeReason>(GPOINTER_TO_INT(data)));
+        return G_SOURCE_REMOVE;
+    }, GINT_TO_POINTER(reason));
+}
+
+std::string statsToJSON()
+{
+    const Policy& p = policy();
+    int64_t currentUs = p.suspended ? g_get_monotonic_time() - p.suspendedAt : 0;
+
+    std::string json = "{\"suspended\":";
+    json += p.suspended ? "true" : "false";
+    json += ",\"suspensions\":" + std::to_string(p.suspensions);
+    json += ",\"totalSuspendedMs\":" + std::to_string((p.totalSuspendedUs + currentUs) / 1000);
+    json += ",\"longestSuspendedMs\":" + std::to_string(std::max(p.longestSuspendedUs, currentUs) / 1000);
+    for (int i = 0; i < ResumeReasonCount; ++i)
+        json += std::string(",\"") + kResumeReasonNames[i] + "\":" + std::to_string(p.resumes[i]);
+    json += '}';
+    return json;
+}
+
+} // namespace
+
+void onTuneStart()
+{
+    Policy& p = policy();
+    cancelTimer(p.resumeTag);
+
+    if (!p.suspended)
+    {
+        p.suspended = true;
+        p.suspendedAt = g_get_monotonic_time();
+        ++p.suspensions;
+        WKBundleMemoryPressureHandlerStop();
+        RDKLOG_INFO("Memory pressure handling suspended for tune");
+    }
+
+    // A new tune keeps the suspension, but never past maxHoldMs from suspendedAt,
+    // so repeated tunes without a first frame can't hold it forever.
+    int64_t heldMs = (g_get_monotonic_time() - p.suspendedAt) / 1000;
+    int64_t remainingMs = std::max<int64_t>(static_cast<int64_t>(p.maxHoldMs) - heldMs, 0);
+    cancelTimer(p.maxHoldTag);
+    p.maxHoldTag = g_timeout_add(static_cast<guint>(remainingMs), [](gpointer) -> gboolean {
+        policy().maxHoldTag = 0;
+        resume(ResumedOnTimeout);
+        return G_SOURCE_REMOVE;
+    }, nullptr);
+}
+
+void onFirstFrame()
+{
+    scheduleResume(ResumedOnFirstFrame, policy().settleMs);
+}
+
+void onTuneFailed()
+{
+    scheduleResume(ResumedOnFailure, 0);
+}
+
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
+{
+    if (WKStringIsEqualToUTF8CString(messageName, "setTuneEvent"))
+    {
+        if (WKGetTypeID(messageBody) != WKStringGetTypeID())
+        {
+            RDKLOG_ERROR("Param must be a string.");
+            return true;
+        }
+
+        WKStringRef event = static_cast<WKStringRef>(messageBody);
+        if (WKStringIsEqualToUTF8CString(event, "start"))
+            onTuneStart();
+        else if (WKStringIsEqualToUTF8CString(event, "firstFrame"))
+            onFirstFrame();
+        else if (WKStringIsEqualToUTF8CString(event, "failed"))
+            onTuneFailed();
+        else
+            RDKLOG_ERROR("Unknown tune event '%s'", Utils::toStdString(event).c_str());
+        return true;
+    }
+
+    if (WKStringIsEqualToUTF8CString(messageName, "getMemoryPressureStats"))
+    {
+        if (WKGetTypeID(messageBody) != WKUInt64GetTypeID())
+        {
+            RDKLOG_ERROR("Unexpected param type.");
+            return true;
+        }
+
+        std::string stats = statsToJSON();
+        WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onMemoryPressureStats"));
+        WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(stats.c_str()));
+
+        WKTypeRef params[] = {messageBody, bodyRef.get()};
+        WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+
+        WKBundlePagePostMessage(page, nameRef.get(), arrRef.get());
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace MemoryPressurePolicy
@@ -0,0 +1,58 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef MEMORYPRESSUREPOLICY_H
+#define MEMORYPRESSUREPOLICY_H
+
+#include <WebKit/WKBundlePage.h>
+#include <WebKit/WKString.h>
+#include <WebKit/WKType.h>
+
+/**
+ * Suspends the WebProcess memory pressure handler while a tune is in
+ * progress, so reclaim doesn't stall the player, and resumes it as soon
+ * as the tune settles. All functions must be called on the main thread.
+ */
+namespace MemoryPressurePolicy
+{
+
+/**
+ * Tune started, suspend memory pressure handling for at most
+ * WPE_TUNE_MAX_HOLD_MS from the start of the suspension.
+ */
+void onTuneStart();
+
+/**
+ * First frame is rendered, resume after the settle delay.
+ */
+void onFirstFrame();
+
+/**
+ * Tune failed, resume right away.
+ */
+void onTuneFailed();
+
+/**
+ * Handles "setTuneEvent" ("start", "firstFrame", "failed") and
+ * "getMemoryPressureStats" (UInt64 id, answered with "onMemoryPressureStats").
+ */
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody);
+
+};
+
+#endif // MEMORYPRESSUREPOLICY_H
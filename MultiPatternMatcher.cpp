@@ -0,0 +1,107 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "MultiPatternMatcher.h"
+
+#include <algorithm>
+#include <iterator>
+#include <queue>
+
+MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string>& patterns)
+{
+    Node root;
+    std::fill(std::begin(root.next), std::end(root.next), -1);
+    root.fail = 0;
+    root.match = kNoMatch;
+    m_nodes.push_back(root);
+
+    // Trie of the patterns.
+    for (size_t i = 0; i < patterns.size(); ++i)
+    {
+        int state = 0;
+        for (unsigned char c : patterns[i])
+        {
+            if (m_nodes[state].next[c] < 0)
+            {
+                Node node;
+                std::fill(std::begin(node.next), std::end(node.next), -1);
+                node.fail = 0;
+                node.match = kNoMatch;
+                m_nodes[state].next[c] = static_cast<int>(m_nodes.size());
+                m_nodes.push_back(node);
+            }
+            state = m_nodes[state].next[c];
+        }
+        if (m_nodes[state].match == kNoMatch)
+            m_nodes[state].match = static_cast<int>(i);
+    }
+
+    // Turn it into a full transition table, breadth first so fail links are final when used.
+    std::queue<int> queue;
+    for (int c = 0; c < 256; ++c)
+    {
+        int child = m_nodes[0].next[c];
+        if (child < 0)
+        {
+            m_nodes[0].next[c] = 0;
+        }
+        else
+        {
+            m_nodes[child].fail = 0;
+            queue.push(child);
+        }
+    }
+
+    while (!queue.empty())
+    {
+        int state = queue.front();
+        queue.pop();
+
+        if (m_nodes[state].match == kNoMatch)
+            m_nodes[state].match = m_nodes[m_nodes[state].fail].match;
+
+        for (int c = 0; c < 256; ++c)
+        {
+            int child = m_nodes[state].next[c];
+            if (child < 0)
+            {
+                m_nodes[state].next[c] = m_nodes[m_nodes[state].fail].next[c];
+            }
+            else
+            {
+                m_nodes[child].fail = m_nodes[m_nodes[state].fail].next[c];
+                queue.push(child);
+            }
+        }
+    }
+}
+
+int MultiPatternMatcher::find(const char* text) const
+{
+    if (!text)
+        return kNoMatch;
+
+    int state = 0;
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(text); *p; ++p)
+    {
+        state = m_nodes[state].next[*p];
+        if (m_nodes[state].match != kNoMatch)
+            return m_nodes[state].match;
+    }
+    return kNoMatch;
+}
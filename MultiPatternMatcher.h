@@ -0,0 +1,53 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef MULTIPATTERNMATCHER_H
+#define MULTIPATTERNMATCHER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Finds any of a fixed set of substrings in one pass over the text (Aho-Corasick).
+ * Build it once, the search itself doesn't allocate.
+ */
+class MultiPatternMatcher
+{
+public:
+    static const int kNoMatch = -1;
+
+    explicit MultiPatternMatcher(const std::vector<std::string>& patterns);
+
+    /**
+     * @return Index of the pattern ending first in text, kNoMatch if none occurs.
+     */
+    int find(const char* text) const;
+
+private:
+    struct Node
+    {
+        int next[256];
+        int fail;
+        int match;
+    };
+
+    std::vector<Node> m_nodes;
+};
+
+#endif // MULTIPATTERNMATCHER_H
@@ -0,0 +1,413 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "NativeServiceManager.h"
+#include "Proxy.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <JavaScriptCore/JSContextRef.h>
+#include <JavaScriptCore/JSObjectRef.h>
+#include <JavaScriptCore/JSStringRef.h>
+#include <JavaScriptCore/JSValueRef.h>
+#include <JavaScriptCore/JSRetainPtr.h>
+
+#include <memory>
+#include <string>
+
+namespace JSBridge
+{
+
+namespace
+{
+
+/**
+ * Private data of a method object: the pair the backend dispatches on.
+ */
+struct ServiceMethod
+{
+    std::string objectName;
+    std::string methodName;
+};
+
+// Same as console.log("Error: " + description + ": " + response) in ServiceManager.js.
+void dumpResponse(JSContextRef ctx, const char* description, size_t argc, const JSValueRef argv[])
+{
+    JSValueRef response = argc ? argv[0] : JSValueMakeUndefined(ctx);
+    JSRetainPtr<JSStringRef> responseStr;
+    if (JSValueIsObject(ctx, response))
+        responseStr = adopt(JSValueCreateJSONString(ctx, response, 0, nullptr));
+    if (!responseStr)
+        responseStr = adopt(JSValueToStringCopy(ctx, response, nullptr));
+
+    std::string line = std::string("Error: ") + description + ": " + Utils::toStdString(responseStr.get());
+
+    JSObjectRef globalObject = JSContextGetGlobalObject(ctx);
+    JSRetainPtr<JSStringRef> consoleStr = adopt(JSStringCreateWithUTF8CString("console"));
+    JSRetainPtr<JSStringRef> logStr = adopt(JSStringCreateWithUTF8CString("log"));
+    JSValueRef console = JSObjectGetProperty(ctx, globalObject, consoleStr.get(), nullptr);
+    if (!console || !JSValueIsObject(ctx, console))
+        return;
+    JSValueRef log = JSObjectGetProperty(ctx, (JSObjectRef) console, logStr.get(), nullptr);
+    if (!log || !JSValueIsObject(ctx, log) || !JSObjectIsFunction(ctx, (JSObjectRef) log))
+        return;
+
+    JSRetainPtr<JSStringRef> lineStr = adopt(JSStringCreateWithUTF8CString(line.c_str()));
+    JSValueRef args[] = { JSValueMakeString(ctx, lineStr.get()) };
+    (void) JSObjectCallAsFunction(ctx, (JSObjectRef) log, (JSObjectRef) console, 1, args, nullptr);
+}
+
+JSValueRef onDummySuccess(JSContextRef ctx, JSObjectRef, JSObjectRef, size_t argc, const JSValueRef argv[], JSValueRef*)
+{
+    dumpResponse(ctx, "Dummy success callback", argc, argv);
+    return JSValueMakeUndefined(ctx);
+}
+
+JSValueRef onFailure(JSContextRef ctx, JSObjectRef, JSObjectRef, size_t argc, const JSValueRef argv[], JSValueRef*)
+{
+    dumpResponse(ctx, "Failure callback", argc, argv);
+    return JSValueMakeUndefined(ctx);
+}
+
+/**
+ * Method table of a backend object. Shared with the object that creates
+ * missing methods, which must not touch the table once it is collected.
+ */
+struct MethodTable
+{
+    std::string objectName;
+    JSObjectRef methods;
+};
+
+typedef std::shared_ptr<MethodTable> MethodTablePtr;
+
+JSClassRef serviceObjectClass();
+JSClassRef methodTableClass();
+JSClassRef methodFactoryClass();
+JSClassRef serviceMethodClass();
+JSClassRef responseClass();
+
+/**
+ * Creates JS object for a backend object. The prototype chain is
+ *   service object -> method table -> method factory
+ * Methods are defined on the table once and found there by plain property
+ * lookup. Only a name not in the table yet reaches the factory's getProperty.
+ */
+JSObjectRef makeServiceObject(JSContextRef ctx, const std::string& objectName)
+{
+    auto table = std::make_shared<MethodTable>();
+    table->objectName = objectName;
+
+    JSObjectRef factory = JSObjectMake(ctx, methodFactoryClass(), new MethodTablePtr(table));
+    JSObjectSetPrototype(ctx, factory, JSValueMakeNull(ctx));
+
+    table->methods = JSObjectMake(ctx, methodTableClass(), new MethodTablePtr(table));
+    JSObjectSetPrototype(ctx, table->methods, factory);
+
+    JSObjectRef object = JSObjectMake(ctx, serviceObjectClass(), new std::string(objectName));
+    JSObjectSetPrototype(ctx, object, table->methods);
+
+    return object;
+}
+
+/**
+ * Creates callable method object. Its prototype is Function.prototype, taken
+ * from a fresh function so a page can't swap it, and call(), apply() and
+ * bind() work as they did on the closures of ServiceManager.js.
+ */
+JSObjectRef makeServiceMethod(JSContextRef ctx, const std::string& objectName, const std::string& methodName)
+{
+    JSObjectRef method = JSObjectMake(ctx, serviceMethodClass(), new ServiceMethod { objectName, methodName });
+    JSObjectSetPrototype(ctx, method, JSObjectGetPrototype(ctx, JSObjectMakeFunctionWithCallback(ctx, nullptr, onDummySuccess)));
+    return method;
+}
+
+// Methods must have what every JS function has.
+bool hasFunctionMethods(JSContextRef ctx, JSObjectRef method)
+{
+    for (const char* name : { "call", "apply", "bind" })
+    {
+        JSRetainPtr<JSStringRef> nameStr = adopt(JSStringCreateWithUTF8CString(name));
+        JSValueRef value = JSObjectGetProperty(ctx, method, nameStr.get(), nullptr);
+        if (!value || !JSValueIsObject(ctx, value) || !JSObjectIsFunction(ctx, (JSObjectRef) value))
+        {
+            RDKLOG_ERROR("Service method has no %s()", name);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Serializes the call and sends it to the backend, like generateMethod() in ServiceManager.js.
+ * Trailing function argument is the success callback.
+ */
+JSValueRef callServiceMethod(JSContextRef ctx, const ServiceMethod& method,
+    size_t argc, const JSValueRef argv[], JSValueRef* exc)
+{
+    JSValueRef callback = nullptr;
+    if (argc && JSValueIsObject(ctx, argv[argc - 1]) && JSObjectIsFunction(ctx, (JSObjectRef) argv[argc - 1]))
+        callback = argv[--argc];
+
+    std::string message = "{\"objectName\":";
+    Utils::appendJSONString(message, method.objectName);
+    message += ",\"methodName\":";
+    Utils::appendJSONString(message, method.methodName);
+    message += ",\"argv\":[";
+    for (size_t i = 0; i < argc; ++i)
+    {
+        if (i)
+            message += ',';
+
+        JSRetainPtr<JSStringRef> json = adopt(JSValueCreateJSONString(ctx, argv[i], 0, exc));
+        if (exc && *exc)
+            return nullptr;
+
+        // JSON.stringify() writes null for values it can't represent inside an array.
+        message += json ? Utils::toStdString(json.get()) : "null";
+    }
+    message += "]}";
+
+    JSRetainPtr<JSStringRef> callbackStr = adopt(JSStringCreateWithUTF8CString("callback"));
+    JSObjectRef onSuccess = JSObjectMake(ctx, responseClass(), nullptr);
+    JSObjectSetProperty(ctx, onSuccess, callbackStr.get(),
+        callback ? callback : JSObjectMakeFunctionWithCallback(ctx, nullptr, onDummySuccess),
+        kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum | kJSPropertyAttributeDontDelete, nullptr);
+    JSObjectRef onError = JSObjectMakeFunctionWithCallback(ctx, nullptr, onFailure);
+
+    Proxy::singleton().sendQuery("onJavaScriptServiceManagerRequest", ctx, message, onSuccess, onError);
+
+    return JSValueMakeUndefined(ctx);
+}
+
+// Reached only for names that are not in the method table yet.
+JSValueRef createMissingMethod(JSContextRef ctx, JSObjectRef factory, JSStringRef propertyName, JSValueRef*)
+{
+    const MethodTablePtr* table = static_cast<const MethodTablePtr*>(JSObjectGetPrivate(factory));
+    if (!table || !(*table)->methods)
+        return nullptr;
+
+    JSObjectRef method = makeServiceMethod(ctx, (*table)->objectName, Utils::toStdString(propertyName));
+    JSObjectSetProperty(ctx, (*table)->methods, propertyName, method,
+        kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete, nullptr);
+
+    return method;
+}
+
+void finalizeMethodFactory(JSObjectRef object)
+{
+    delete static_cast<MethodTablePtr*>(JSObjectGetPrivate(object));
+}
+
+void finalizeMethodTable(JSObjectRef object)
+{
+    MethodTablePtr* table = static_cast<MethodTablePtr*>(JSObjectGetPrivate(object));
+    if (!table)
+        return;
+    (*table)->methods = nullptr;
+    delete table;
+}
+
+// Assignment calls the method with the assigned value, as the Proxy 'set' trap did.
+bool setServiceObjectProperty(JSContextRef ctx, JSObjectRef object, JSStringRef propertyName, JSValueRef value, JSValueRef* exc)
+{
+    const std::string* objectName = static_cast<const std::string*>(JSObjectGetPrivate(object));
+    if (!objectName)
+        return false;
+
+    ServiceMethod method { *objectName, Utils::toStdString(propertyName) };
+    (void) callServiceMethod(ctx, method, 1, &value, exc);
+    return true;
+}
+
+void finalizeServiceObject(JSObjectRef object)
+{
+    delete static_cast<std::string*>(JSObjectGetPrivate(object));
+}
+
+JSValueRef onServiceMethodCall(JSContextRef ctx, JSObjectRef function, JSObjectRef,
+    size_t argc, const JSValueRef argv[], JSValueRef* exc)
+{
+    const ServiceMethod* method = static_cast<const ServiceMethod*>(JSObjectGetPrivate(function));
+    if (!method)
+        return JSValueMakeUndefined(ctx);
+
+    return callServiceMethod(ctx, *method, argc, argv, exc);
+}
+
+void finalizeServiceMethod(JSObjectRef object)
+{
+    delete static_cast<ServiceMethod*>(JSObjectGetPrivate(object));
+}
+
+// Parses backend response and forwards the result to the stored callback.
+// Object results become service objects.
+JSValueRef onServiceResponse(JSContextRef ctx, JSObjectRef function, JSObjectRef,
+    size_t argc, const JSValueRef argv[], JSValueRef* exc)
+{
+    JSRetainPtr<JSStringRef> callbackStr = adopt(JSStringCreateWithUTF8CString("callback"));
+    JSValueRef callback = JSObjectGetProperty(ctx, function, callbackStr.get(), nullptr);
+    if (argc < 1 || !callback || !JSValueIsObject(ctx, callback))
+        return JSValueMakeUndefined(ctx);
+
+    JSRetainPtr<JSStringRef> response = adopt(JSValueToStringCopy(ctx, argv[0], exc));
+    if (!response)
+        return nullptr;
+
+    JSValueRef responseObj = JSValueMakeFromJSONString(ctx, response.get());
+    if (!responseObj || !JSValueIsObject(ctx, responseObj))
+    {
+        RDKLOG_ERROR("Unexpected ServiceManager response: %s", Utils::toStdString(response.get()).c_str());
+        return JSValueMakeUndefined(ctx);
+    }
+
+    JSRetainPtr<JSStringRef> objectNameStr = adopt(JSStringCreateWithUTF8CString("objectName"));
+    JSRetainPtr<JSStringRef> valueStr = adopt(JSStringCreateWithUTF8CString("value"));
+
+    JSValueRef result;
+    JSValueRef objectName = JSObjectGetProperty(ctx, (JSObjectRef) responseObj, objectNameStr.get(), nullptr);
+    if (objectName && JSValueToBoolean(ctx, objectName))
+    {
+        JSRetainPtr<JSStringRef> name = adopt(JSValueToStringCopy(ctx, objectName, nullptr));
+        result = makeServiceObject(ctx, Utils::toStdString(name.get()));
+    }
+    else
+    {
+        result = JSObjectGetProperty(ctx, (JSObjectRef) responseObj, valueStr.get(), nullptr);
+        if (!result)
+            result = JSValueMakeUndefined(ctx);
+    }
+
+    return JSObjectCallAsFunction(ctx, (JSObjectRef) callback, nullptr, 1, &result, exc);
+}
+
+// window.ServiceManager.generateMethod(objectName, methodName)
+JSValueRef onGenerateMethod(JSContextRef ctx, JSObjectRef, JSObjectRef,
+    size_t argc, const JSValueRef argv[], JSValueRef* exc)
+{
+    std::string names[2];
+    for (size_t i = 0; i < 2 && i < argc; ++i)
+    {
+        JSRetainPtr<JSStringRef> str = adopt(JSValueToStringCopy(ctx, argv[i], exc));
+        if (!str)
+            return nullptr;
+        names[i] = Utils::toStdString(str.get());
+    }
+
+    return makeServiceMethod(ctx, names[0], names[1]);
+}
+
+JSClassRef serviceObjectClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "ServiceObject";
+        definition.attributes = kJSClassAttributeNoAutomaticPrototype;
+        definition.setProperty = setServiceObjectProperty;
+        definition.finalize = finalizeServiceObject;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+JSClassRef methodTableClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "ServiceMethodTable";
+        definition.attributes = kJSClassAttributeNoAutomaticPrototype;
+        definition.finalize = finalizeMethodTable;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+JSClassRef methodFactoryClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "ServiceMethodFactory";
+        definition.attributes = kJSClassAttributeNoAutomaticPrototype;
+        definition.getProperty = createMissingMethod;
+        definition.finalize = finalizeMethodFactory;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+JSClassRef serviceMethodClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "ServiceMethod";
+        definition.callAsFunction = onServiceMethodCall;
+        definition.finalize = finalizeServiceMethod;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+JSClassRef responseClass()
+{
+    static JSClassRef jsClass = [] {
+        JSClassDefinition definition = kJSClassDefinitionEmpty;
+        definition.className = "ServiceResponse";
+        definition.callAsFunction = onServiceResponse;
+        return JSClassCreate(&definition);
+    }();
+    return jsClass;
+}
+
+} // namespace
+
+bool injectNativeServiceManager(JSContextRef context)
+{
+    JSObjectRef windowObject = JSContextGetGlobalObject(context);
+    JSObjectRef serviceManager = JSObjectMake(context, nullptr, nullptr);
+
+    JSRetainPtr<JSStringRef> versionStr = adopt(JSStringCreateWithUTF8CString("version"));
+    JSRetainPtr<JSStringRef> versionValueStr = adopt(JSStringCreateWithUTF8CString("2.0"));
+    JSObjectSetProperty(context, serviceManager, versionStr.get(),
+        JSValueMakeString(context, versionValueStr.get()), kJSPropertyAttributeNone, nullptr);
+
+    JSRetainPtr<JSStringRef> generateMethodStr = adopt(JSStringCreateWithUTF8CString("generateMethod"));
+    JSObjectSetProperty(context, serviceManager, generateMethodStr.get(),
+        JSObjectMakeFunctionWithCallback(context, generateMethodStr.get(), onGenerateMethod),
+        kJSPropertyAttributeNone, nullptr);
+
+    JSRetainPtr<JSStringRef> getServiceStr = adopt(JSStringCreateWithUTF8CString("getServiceForJavaScript"));
+    JSObjectRef getService = makeServiceMethod(context, "ServiceManager", "getServiceForJavaScript");
+    if (!hasFunctionMethods(context, getService))
+        return false;
+    JSObjectSetProperty(context, serviceManager, getServiceStr.get(), getService,
+        kJSPropertyAttributeNone, nullptr);
+
+    JSValueRef exc = 0;
+    JSRetainPtr<JSStringRef> serviceManagerStr = adopt(JSStringCreateWithUTF8CString("ServiceManager"));
+    JSObjectSetProperty(context, windowObject, serviceManagerStr.get(), serviceManager,
+        kJSPropertyAttributeNone, &exc);
+    if (exc)
+    {
+        RDKLOG_ERROR("Could not set property ServiceManager!");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace JSBridge
@@ -0,0 +1,40 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef JSBRIDGE_NATIVE_SERVICE_MANAGER_H
+#define JSBRIDGE_NATIVE_SERVICE_MANAGER_H
+
+#include <JavaScriptCore/JSBase.h>
+
+namespace JSBridge
+{
+
+/**
+ * Installs native implementation of window.ServiceManager.
+ * Behaves like ServiceManager.js, but service objects are JSClass instances
+ * with a per-object method table on their prototype chain instead of ES Proxies,
+ * so a method is generated once per object and name. Calls are
+ * serialized straight into the bridge.
+ * @return false if window.ServiceManager could not be set, or if method
+ * objects would lack call(), apply() and bind().
+ */
+bool injectNativeServiceManager(JSContextRef context);
+
+} // namespace JSBridge
+
+#endif // JSBRIDGE_NATIVE_SERVICE_MANAGER_H
@@ -19,16 +19,23 @@
 #include "NavMetrics.h"
 
 #include <WebKit/WKBundleFrame.h>
+#include <WebKit/WKBundleScriptWorld.h>
 #include <WebKit/WKArray.h>
 #include <WebKit/WKNumber.h>
 #include <WebKit/WKRetainPtr.h>
+#include <WebKit/WKURL.h>
 
 #include <JavaScriptCore/JSContextRef.h>
 #include <JavaScriptCore/JSObjectRef.h>
 #include <JavaScriptCore/JSStringRef.h>
 #include <JavaScriptCore/JSValueRef.h>
+#include <JavaScriptCore/JSRetainPtr.h>
 
+#include <algorithm>
+#include <stdlib.h>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glib.h>
 
@@ -38,67 +45,462 @@
 namespace NavMetrics
 {
 
-static const char kPerfomanceTimingScriptStr[] =
-"(function() {"
-    "var timingJSON = performance.timing.toJSON();"
-    "var navigationStart = timingJSON.navigationStart;"
-    "var result = {};"
-    "for(var k in timingJSON)"
-       "if (timingJSON[k] > navigationStart) result[k] = timingJSON[k] - navigationStart;"
-    "var entries = performance.getEntries();"
-    "result[\"entriesLen\"] = entries ? entries.length : 0;"
-    "return JSON.stringify(result);"
-"})()";
+// PerformanceTiming attributes, in the order performance.timing.toJSON() lists them.
+static const char* const kTimingNames[] = {
+    "navigationStart",
+    "unloadEventStart",
+    "unloadEventEnd",
+    "redirectStart",
+    "redirectEnd",
+    "fetchStart",
+    "domainLookupStart",
+    "domainLookupEnd",
+    "connectStart",
+    "connectEnd",
+    "secureConnectionStart",
+    "requestStart",
+    "responseStart",
+    "responseEnd",
+    "domLoading",
+    "domInteractive",
+    "domContentLoadedEventStart",
+    "domContentLoadedEventEnd",
+    "domComplete",
+    "loadEventStart",
+    "loadEventEnd",
+};
 
-static std::string g_timingStr;
+static const size_t kTimingCount = sizeof(kTimingNames) / sizeof(kTimingNames[0]);
 
-static std::string jsToStdString(JSStringRef jsStr)
+static JSStringRef cachedName(const char* name)
 {
-    if (!jsStr)
-        return { };
+    static std::unordered_map<std::string, JSStringRef> names;
+    auto it = names.find(name);
+    if (it == names.end())
+        it = names.emplace(name, JSStringCreateWithUTF8CString(name)).first;
+    return it->second;
+}
 
-    size_t len = JSStringGetMaximumUTF8CStringSize(jsStr);
-    if (!len)
-        return { };
+static JSStringRef timingName(size_t index)
+{
+    static JSStringRef* names = [] {
+        JSStringRef* names = new JSStringRef[kTimingCount];
+        for (size_t i = 0; i < kTimingCount; ++i)
+            names[i] = JSStringCreateWithUTF8CString(kTimingNames[i]);
+        return names;
+    }();
+    return names[index];
+}
 
-    std::unique_ptr<char[]> buffer(new char[len]);
-    len = JSStringGetUTF8CString(jsStr, buffer.get(), len);
-    if (!len)
-        return { };
+/**
+ * window.performance, performance.timing with its attribute getters and
+ * getEntries() captured before any page script ran, so a page can't
+ * shadow or redefine them.
+ */
+struct PerformanceHandles
+{
+    JSGlobalContextRef context { nullptr };
+    JSObjectRef performance { nullptr };
+    JSObjectRef timing { nullptr };
+    // Getter of each kTimingNames attribute, null to read the property instead.
+    JSObjectRef timingGetters[kTimingCount] { };
+    JSObjectRef getEntries { nullptr };
+    JSObjectRef getEntriesByType { nullptr };
+
+    void clear()
+    {
+        if (!context)
+            return;
+        JSValueUnprotect(context, performance);
+        if (timing)
+            JSValueUnprotect(context, timing);
+        for (JSObjectRef& getter : timingGetters)
+        {
+            if (getter)
+                JSValueUnprotect(context, getter);
+            getter = nullptr;
+        }
+        if (getEntries)
+            JSValueUnprotect(context, getEntries);
+        if (getEntriesByType)
+            JSValueUnprotect(context, getEntriesByType);
+        JSGlobalContextRelease(context);
+        context = nullptr;
+        performance = nullptr;
+        timing = nullptr;
+        getEntries = nullptr;
+        getEntriesByType = nullptr;
+    }
+};
+
+/**
+ * One onload of a main frame document.
+ */
+struct NavigationRecord
+{
+    std::string url;
+    // Wall clock, milliseconds since epoch.
+    int64_t timestamp;
+    // JSON object of timing marks, see getPerfomanceTiming.
+    std::string timing;
+    // Paint timing in ms from navigationStart, negative if not reported.
+    double firstPaint { -1 };
+    double firstContentfulPaint { -1 };
+    // Long tasks seen by the document until the record was pushed or replaced.
+    uint32_t longTasks { 0 };
+    double longTaskTime { 0 };
+    // Layout milestones in ms from provisional load start, negative if not reached.
+    double firstLayout { -1 };
+    double firstVisuallyNonEmptyLayout { -1 };
+    double lastLayout { -1 };
+    uint32_t layouts { 0 };
+};
+
+/**
+ * Last navigations of a page, oldest overwritten first.
+ */
+class NavigationHistory
+{
+public:
+    NavigationHistory()
+        : m_records(capacity())
+        , m_next(0)
+        , m_count(0)
+    {
+    }
+
+    void add(NavigationRecord&& record)
+    {
+        m_records[m_next] = std::move(record);
+        m_next = (m_next + 1) % m_records.size();
+        m_count = std::min(m_count + 1, m_records.size());
+    }
+
+    const NavigationRecord* latest() const
+    {
+        return m_count ? &m_records[(m_next + m_records.size() - 1) % m_records.size()] : nullptr;
+    }
+
+    NavigationRecord* latest()
+    {
+        return m_count ? &m_records[(m_next + m_records.size() - 1) % m_records.size()] : nullptr;
+    }
+
+    template <typename Function>
+    void forEach(Function&& function) const
+    {
+        size_t first = (m_next + m_records.size() - m_count) % m_records.size();
+        for (size_t i = 0; i < m_count; ++i)
+            function(m_records[(first + i) % m_records.size()]);
+    }
 
-    return std::string { buffer.get(), len };
+private:
+    static size_t capacity()
+    {
+        static size_t capacity = [] {
+            const char* s = getenv("WPE_NAV_METRICS_HISTORY");
+            int value = s ? atoi(s) : 0;
+            return static_cast<size_t>(value > 0 ? value : 16);
+        }();
+        return capacity;
+    }
+
+    std::vector<NavigationRecord> m_records;
+    size_t m_next;
+    size_t m_count;
+};
+
+struct PageMetrics
+{
+    PerformanceHandles performance;
+    NavigationHistory history;
+    // Onload of the current document is in history.
+    bool recorded { false };
+    // Long tasks of the current document before onload.
+    uint32_t longTasks { 0 };
+    double longTaskTime { 0 };
+    // Monotonic time the main frame provisional load of the current document
+    // started, and its layout milestones before onload. The next navigation's
+    // start becomes the document start when its window object is cleared,
+    // until then layouts still belong to the outgoing document.
+    int64_t documentStart { 0 };
+    int64_t provisionalStart { 0 };
+    NavigationRecord layout;
+    // Push mode, one onNavigationMetrics message per navigation.
+    bool subscribed { false };
+    guint pushTag { 0 };
+};
+
+static std::unordered_map<WKBundlePageRef, PageMetrics> g_pages;
+
+static JSObjectRef getObjectProperty(JSContextRef context, JSObjectRef object, const char* name)
+{
+    JSValueRef exception = nullptr;
+    JSValueRef value = JSObjectGetProperty(context, object, cachedName(name), &exception);
+    if (exception || !value || !JSValueIsObject(context, value))
+        return nullptr;
+    return JSValueToObject(context, value, nullptr);
 }
 
 static std::string getPerfomanceTiming(WKBundlePageRef page)
 {
-    if (!page)
+    auto it = g_pages.find(page);
+    if (it == g_pages.end() || !it->second.performance.context)
         return { };
 
-    WKBundleFrameRef mainFrame = WKBundlePageGetMainFrame(page);
-    if (!mainFrame)
+    const PerformanceHandles& handles = it->second.performance;
+    JSContextRef context = handles.context;
+    if (!handles.timing)
         return { };
 
-    JSGlobalContextRef jsContext = WKBundleFrameGetJavaScriptContext(mainFrame);
-    if (!jsContext)
-        return { };
+    double values[kTimingCount];
+    for (size_t i = 0; i < kTimingCount; ++i)
+    {
+        JSValueRef value = handles.timingGetters[i]
+            ? JSObjectCallAsFunction(context, handles.timingGetters[i], handles.timing, 0, nullptr, nullptr)
+            : JSObjectGetProperty(context, handles.timing, timingName(i), nullptr);
+        values[i] = value && JSValueIsNumber(context, value) ? JSValueToNumber(context, value, nullptr) : 0;
+    }
 
-    JSObjectRef jsGlobalObj = JSContextGetGlobalObject(jsContext);
-    JSStringRef jsStr = JSStringCreateWithUTF8CString(kPerfomanceTimingScriptStr);
-    JSValueRef jsException = nullptr;
-    JSValueRef jsResult = JSEvaluateScript(jsContext, jsStr, jsGlobalObj, nullptr, 0, &jsException);
-    JSStringRelease(jsStr);
+    // Same shape as before: offsets from navigationStart for the marks that are set.
+    const double navigationStart = values[0];
+    std::string result = "{";
+    for (size_t i = 0; i < kTimingCount; ++i)
+    {
+        if (!(values[i] > navigationStart))
+            continue;
+        if (result.size() > 1)
+            result += ',';
+        result += '"';
+        result += kTimingNames[i];
+        result += "\":";
+        result += std::to_string(static_cast<long long>(values[i] - navigationStart));
+    }
 
-    if (jsException)
-        return { };
+    size_t entriesLen = 0;
+    if (handles.getEntries)
+    {
+        JSValueRef exception = nullptr;
+        JSValueRef entries = JSObjectCallAsFunction(context, handles.getEntries, handles.performance, 0, nullptr, &exception);
+        if (!exception && entries && JSValueIsObject(context, entries))
+        {
+            JSValueRef length = JSObjectGetProperty(context, JSValueToObject(context, entries, nullptr), cachedName("length"), nullptr);
+            if (length && JSValueIsNumber(context, length))
+                entriesLen = static_cast<size_t>(JSValueToNumber(context, length, nullptr));
+        }
+    }
+    if (result.size() > 1)
+        result += ',';
+    result += "\"entriesLen\":" + std::to_string(entriesLen) + "}";
 
-    JSStringRef  jsResultStr = JSValueToStringCopy(jsContext, jsResult, nullptr);
-    if (!jsResultStr)
-        return { };
+    return result;
+}
 
-    std::string result = jsToStdString(jsResultStr);
-    JSStringRelease(jsResultStr);
+static double getNumberProperty(JSContextRef context, JSObjectRef object, const char* name)
+{
+    JSValueRef value = JSObjectGetProperty(context, object, cachedName(name), nullptr);
+    return value && JSValueIsNumber(context, value) ? JSValueToNumber(context, value, nullptr) : 0;
+}
 
-    return result;
+// Calls function on each element of an array-like object.
+template <typename Function>
+static void forEachElement(JSContextRef context, JSValueRef array, Function&& function)
+{
+    if (!array || !JSValueIsObject(context, array))
+        return;
+    JSObjectRef object = JSValueToObject(context, array, nullptr);
+    size_t length = static_cast<size_t>(getNumberProperty(context, object, "length"));
+    for (size_t i = 0; i < length; ++i)
+    {
+        JSValueRef item = JSObjectGetPropertyAtIndex(context, object, i, nullptr);
+        if (item && JSValueIsObject(context, item))
+            function(JSValueToObject(context, item, nullptr));
+    }
+}
+
+static void getPaintTiming(WKBundlePageRef page, NavigationRecord& record)
+{
+    auto it = g_pages.find(page);
+    if (it == g_pages.end() || !it->second.performance.getEntriesByType)
+        return;
+
+    const PerformanceHandles& handles = it->second.performance;
+    JSContextRef context = handles.context;
+
+    JSRetainPtr<JSStringRef> paintStr = adopt(JSStringCreateWithUTF8CString("paint"));
+    JSValueRef argv[] = { JSValueMakeString(context, paintStr.get()) };
+    JSValueRef exception = nullptr;
+    JSValueRef entries = JSObjectCallAsFunction(context, handles.getEntriesByType, handles.performance, 1, argv, &exception);
+    if (exception)
+        return;
+
+    forEachElement(context, entries, [&](JSObjectRef entry) {
+        JSValueRef name = JSObjectGetProperty(context, entry, cachedName("name"), nullptr);
+        if (!name || !JSValueIsString(context, name))
+            return;
+        JSRetainPtr<JSStringRef> nameStr = adopt(JSValueToStringCopy(context, name, nullptr));
+        double startTime = getNumberProperty(context, entry, "startTime");
+        if (JSStringIsEqualToUTF8CString(nameStr.get(), "first-paint"))
+            record.firstPaint = startTime;
+        else if (JSStringIsEqualToUTF8CString(nameStr.get(), "first-contentful-paint"))
+            record.firstContentfulPaint = startTime;
+    });
+}
+
+// PerformanceObserver callback for "longtask" entries.
+static JSValueRef onLongTasks(JSContextRef context, JSObjectRef, JSObjectRef,
+    size_t argumentCount, const JSValueRef arguments[], JSValueRef*)
+{
+    if (argumentCount < 1 || !JSValueIsObject(context, arguments[0]))
+        return JSValueMakeUndefined(context);
+
+    WKBundleFrameRef frame = WKBundleFrameForJavaScriptContext(context);
+    auto it = frame ? g_pages.find(WKBundleFrameGetPage(frame)) : g_pages.end();
+    if (it == g_pages.end())
+        return JSValueMakeUndefined(context);
+
+    JSObjectRef list = JSValueToObject(context, arguments[0], nullptr);
+    JSObjectRef getEntries = getObjectProperty(context, list, "getEntries");
+    if (!getEntries || !JSObjectIsFunction(context, getEntries))
+        return JSValueMakeUndefined(context);
+
+    uint32_t count = 0;
+    double time = 0;
+    forEachElement(context, JSObjectCallAsFunction(context, getEntries, list, 0, nullptr, nullptr), [&](JSObjectRef entry) {
+        ++count;
+        time += getNumberProperty(context, entry, "duration");
+    });
+
+    // After onload the tasks belong to the record that is waiting to be pushed.
+    PageMetrics& metrics = it->second;
+    NavigationRecord* record = metrics.recorded ? metrics.history.latest() : nullptr;
+    uint32_t& longTasks = record ? record->longTasks : metrics.longTasks;
+    double& longTaskTime = record ? record->longTaskTime : metrics.longTaskTime;
+    longTasks += count;
+    longTaskTime += time;
+
+    return JSValueMakeUndefined(context);
+}
+
+// new PerformanceObserver(onLongTasks).observe({ entryTypes: ["longtask"] })
+static void observeLongTasks(JSContextRef context)
+{
+    JSObjectRef observerCtor = getObjectProperty(context, JSContextGetGlobalObject(context), "PerformanceObserver");
+    if (!observerCtor || !JSObjectIsConstructor(context, observerCtor))
+        return;
+
+    JSValueRef exception = nullptr;
+    JSValueRef callback = JSObjectMakeFunctionWithCallback(context, nullptr, onLongTasks);
+    JSObjectRef observer = JSObjectCallAsConstructor(context, observerCtor, 1, &callback, &exception);
+    if (exception || !observer)
+        return;
+
+    JSObjectRef observe = getObjectProperty(context, observer, "observe");
+    if (!observe || !JSObjectIsFunction(context, observe))
+        return;
+
+    JSRetainPtr<JSStringRef> longTaskStr = adopt(JSStringCreateWithUTF8CString("longtask"));
+    JSValueRef entryType = JSValueMakeString(context, longTaskStr.get());
+    JSObjectRef options = JSObjectMake(context, nullptr, nullptr);
+    JSObjectSetProperty(context, options, cachedName("entryTypes"),
+        JSObjectMakeArray(context, 1, &entryType, nullptr), kJSPropertyAttributeNone, nullptr);
+
+    JSValueRef argv[] = { options };
+    (void) JSObjectCallAsFunction(context, observe, observer, 1, argv, &exception);
+    if (exception)
+        RDKLOG_TRACE("Long tasks are not observable");
+}
+
+static void postReply(WKBundlePageRef page, const char* name, WKTypeRef id, const std::string& json)
+{
+    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString(name));
+    WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(json.c_str()));
+
+    WKTypeRef params[] = {id, bodyRef.get()};
+    WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+
+    WKBundlePagePostMessage(page, nameRef.get(), arrRef.get());
+}
+
+static void appendRecordJSON(std::string& json, const NavigationRecord& record)
+{
+    json += "{\"url\":";
+    Utils::appendJSONString(json, record.url);
+    json += ",\"timestamp\":" + std::to_string(record.timestamp);
+    json += ",\"timing\":" + (record.timing.empty() ? std::string("{}") : record.timing);
+    if (record.firstPaint >= 0)
+        json += ",\"firstPaint\":" + std::to_string(static_cast<long long>(record.firstPaint));
+    if (record.firstContentfulPaint >= 0)
+        json += ",\"firstContentfulPaint\":" + std::to_string(static_cast<long long>(record.firstContentfulPaint));
+    json += ",\"longTasks\":" + std::to_string(record.longTasks);
+    json += ",\"longTaskTime\":" + std::to_string(static_cast<long long>(record.longTaskTime));
+    if (record.firstLayout >= 0)
+        json += ",\"firstLayout\":" + std::to_string(static_cast<long long>(record.firstLayout));
+    if (record.firstVisuallyNonEmptyLayout >= 0)
+        json += ",\"firstVisuallyNonEmptyLayout\":" + std::to_string(static_cast<long long>(record.firstVisuallyNonEmptyLayout));
+    if (record.lastLayout >= 0)
+        json += ",\"lastLayout\":" + std::to_string(static_cast<long long>(record.lastLayout));
+    json += ",\"layouts\":" + std::to_string(record.layouts);
+    json += '}';
+}
+
+static std::string historyToJSON(const NavigationHistory& history)
+{
+    std::string json = "{\"records\":[";
+    bool first = true;
+    history.forEach([&](const NavigationRecord& record) {
+        if (!first)
+            json += ',';
+        first = false;
+        appendRecordJSON(json, record);
+    });
+    json += "]}";
+    return json;
+}
+
+static void pushRecord(WKBundlePageRef page, PageMetrics& metrics)
+{
+    if (metrics.pushTag)
+    {
+        g_source_remove(metrics.pushTag);
+        metrics.pushTag = 0;
+    }
+
+    NavigationRecord* record = metrics.history.latest();
+    if (!record)
+        return;
+
+    // Paint entries may have been reported after onload, the handles still belong to this document.
+    getPaintTiming(page, *record);
+
+    std::string json;
+    appendRecordJSON(json, *record);
+
+    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onNavigationMetrics"));
+    WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(json.c_str()));
+    WKBundlePagePostMessage(page, nameRef.get(), bodyRef.get());
+}
+
+// Gives late paint and long task entries a chance to land in the same message.
+static void schedulePush(WKBundlePageRef page, PageMetrics& metrics)
+{
+    static guint delayMs = [] {
+        const char* s = getenv("WPE_NAV_METRICS_PUSH_DELAY_MS");
+        return static_cast<guint>(s ? std::max(atoi(s), 0) : 1000);
+    }();
+
+    if (metrics.pushTag)
+        g_source_remove(metrics.pushTag);
+    metrics.pushTag = g_timeout_add(delayMs, [](gpointer data) -> gboolean {
+        WKBundlePageRef page = static_cast<WKBundlePageRef>(data);
+        auto it = g_pages.find(page);
+        if (it != g_pages.end())
+        {
+            it->second.pushTag = 0;
+            pushRecord(page, it->second);
+        }
+        return G_SOURCE_REMOVE;
+    }, const_cast<void*>(static_cast<const void*>(page)));
 }
 
 bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
@@ -111,20 +513,43 @@ bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTy
             return true;
         }
 
-        if (g_timingStr.empty())
-            g_timingStr = getPerfomanceTiming(page);
+        // Before onload this is whatever the current document has so far.
+        const PageMetrics& metrics = g_pages[page];
+        std::string timing = metrics.recorded ? metrics.history.latest()->timing : getPerfomanceTiming(page);
 
-        RDKLOG_TRACE("Return navigation timing: '%s'", g_timingStr.c_str());
+        RDKLOG_TRACE("Return navigation timing: '%s'", timing.c_str());
+        postReply(page, "onNavigationTiming", messageBody, timing);
+        return true;
+    }
 
-        WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onNavigationTiming"));
-        WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(g_timingStr.c_str()));
+    if (WKStringIsEqualToUTF8CString(messageName, "getNavigationHistory"))
+    {
+        if (WKGetTypeID(messageBody) != WKUInt64GetTypeID())
+        {
+            RDKLOG_ERROR("Unexpected param type.");
+            return true;
+        }
 
-        WKTypeRef params[] = {messageBody, bodyRef.get()};
-        WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+        postReply(page, "onNavigationHistory", messageBody, historyToJSON(g_pages[page].history));
+        return true;
+    }
 
-        WKBundlePagePostMessage(page, nameRef.get(), arrRef.get());
+    if (WKStringIsEqualToUTF8CString(messageName, "subscribeNavigationMetrics"))
+    {
+        if (WKGetTypeID(messageBody) != WKBooleanGetTypeID())
+        {
+            RDKLOG_ERROR("Unexpected param type.");
+            return true;
+        }
 
-        g_timingStr.clear();
+        PageMetrics& metrics = g_pages[page];
+        metrics.subscribed = WKBooleanGetValue(static_cast<WKBooleanRef>(messageBody));
+        if (!metrics.subscribed && metrics.pushTag)
+        {
+            g_source_remove(metrics.pushTag);
+            metrics.pushTag = 0;
+        }
+        RDKLOG_INFO("Navigation metrics push %s", metrics.subscribed ? "enabled" : "disabled");
         return true;
     }
     return false;
@@ -132,8 +557,187 @@ bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTy
 
 void didHandleOnloadEventsForFrame(WKBundlePageRef page, WKBundleFrameRef frame)
 {
-    if (WKBundleFrameIsMainFrame(frame))
-        g_timingStr = getPerfomanceTiming(page);
+    if (!WKBundleFrameIsMainFrame(frame))
+        return;
+
+    NavigationRecord record;
+    WKRetainPtr<WKURLRef> wkUrl = adoptWK(WKBundleFrameCopyURL(frame));
+    if (wkUrl)
+        record.url = Utils::toStdString(adoptWK(WKURLCopyString(wkUrl.get())).get());
+    record.timestamp = g_get_real_time() / 1000;
+    record.timing = getPerfomanceTiming(page);
+    getPaintTiming(page, record);
+
+    PageMetrics& metrics = g_pages[page];
+    record.longTasks = metrics.longTasks;
+    record.longTaskTime = metrics.longTaskTime;
+    record.firstLayout = metrics.layout.firstLayout;
+    record.firstVisuallyNonEmptyLayout = metrics.layout.firstVisuallyNonEmptyLayout;
+    record.lastLayout = metrics.layout.lastLayout;
+    record.layouts = metrics.layout.layouts;
+    metrics.history.add(std::move(record));
+    metrics.recorded = true;
+
+    if (metrics.subscribed)
+        schedulePush(page, metrics);
+}
+
+// Layout milestones go to the pending record once onload has been recorded.
+static NavigationRecord* layoutRecord(WKBundlePageRef page, WKBundleFrameRef frame, double& elapsed)
+{
+    if (!WKBundleFrameIsMainFrame(frame))
+        return nullptr;
+
+    auto it = g_pages.find(page);
+    if (it == g_pages.end() || !it->second.documentStart)
+        return nullptr;
+
+    PageMetrics& metrics = it->second;
+    elapsed = (g_get_monotonic_time() - metrics.documentStart) / 1000.0;
+    return metrics.recorded ? metrics.history.latest() : &metrics.layout;
+}
+
+void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    if (!WKBundleFrameIsMainFrame(frame))
+        return;
+
+    g_pages[page].provisionalStart = g_get_monotonic_time();
+}
+
+void didFirstLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    double elapsed;
+    if (NavigationRecord* record = layoutRecord(page, frame, elapsed))
+    {
+        if (record->firstLayout < 0)
+            record->firstLayout = elapsed;
+    }
+}
+
+void didFirstVisuallyNonEmptyLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    double elapsed;
+    if (NavigationRecord* record = layoutRecord(page, frame, elapsed))
+    {
+        if (record->firstVisuallyNonEmptyLayout < 0)
+            record->firstVisuallyNonEmptyLayout = elapsed;
+    }
+}
+
+void didLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    double elapsed;
+    if (NavigationRecord* record = layoutRecord(page, frame, elapsed))
+    {
+        record->lastLayout = elapsed;
+        ++record->layouts;
+    }
+}
+
+// Object.getOwnPropertyDescriptor(object, name).get, if it is a function.
+static JSObjectRef getPropertyGetter(JSContextRef context, JSObjectRef getOwnPropertyDescriptor, JSObjectRef object, JSStringRef name)
+{
+    JSValueRef argv[] = { object, JSValueMakeString(context, name) };
+    JSValueRef exception = nullptr;
+    JSValueRef descriptor = JSObjectCallAsFunction(context, getOwnPropertyDescriptor, nullptr, 2, argv, &exception);
+    if (exception || !descriptor || !JSValueIsObject(context, descriptor))
+        return nullptr;
+    JSObjectRef getter = getObjectProperty(context, JSValueToObject(context, descriptor, nullptr), "get");
+    return getter && JSObjectIsFunction(context, getter) ? getter : nullptr;
+}
+
+// performance.timing keeps its identity, its attributes are read through
+// the PerformanceTiming.prototype getters as they are now.
+static void captureTiming(JSContextRef context, PerformanceHandles& handles)
+{
+    JSObjectRef timing = getObjectProperty(context, handles.performance, "timing");
+    if (!timing)
+        return;
+    handles.timing = timing;
+    JSValueProtect(context, timing);
+
+    JSObjectRef object = getObjectProperty(context, JSContextGetGlobalObject(context), "Object");
+    JSObjectRef getOwnPropertyDescriptor = object ? getObjectProperty(context, object, "getOwnPropertyDescriptor") : nullptr;
+    JSValueRef prototype = JSObjectGetPrototype(context, timing);
+    if (!getOwnPropertyDescriptor || !JSObjectIsFunction(context, getOwnPropertyDescriptor) || !JSValueIsObject(context, prototype))
+        return;
+
+    JSObjectRef prototypeObject = JSValueToObject(context, prototype, nullptr);
+    for (size_t i = 0; i < kTimingCount; ++i)
+    {
+        JSObjectRef getter = getPropertyGetter(context, getOwnPropertyDescriptor, prototypeObject, timingName(i));
+        if (!getter)
+            continue;
+        handles.timingGetters[i] = getter;
+        JSValueProtect(context, getter);
+    }
+}
+
+void didClearWindowObjectForFrame(WKBundlePageRef page, WKBundleFrameRef frame, WKBundleScriptWorldRef world)
+{
+    if (!WKBundleFrameIsMainFrame(frame) || world != WKBundleScriptWorldNormalWorld())
+        return;
+
+    PageMetrics& metrics = g_pages[page];
+    // New document, the previous one won't add anything anymore.
+    if (metrics.pushTag)
+        pushRecord(page, metrics);
+    metrics.recorded = false;
+    metrics.longTasks = 0;
+    metrics.longTaskTime = 0;
+    if (metrics.provisionalStart)
+    {
+        metrics.documentStart = metrics.provisionalStart;
+        metrics.provisionalStart = 0;
+    }
+    metrics.layout = NavigationRecord();
+
+    PerformanceHandles& handles = metrics.performance;
+    handles.clear();
+
+    JSGlobalContextRef context = WKBundleFrameGetJavaScriptContext(frame);
+    if (!context)
+        return;
+
+    JSObjectRef performance = getObjectProperty(context, JSContextGetGlobalObject(context), "performance");
+    if (!performance)
+    {
+        RDKLOG_ERROR("No window.performance");
+        return;
+    }
+
+    JSObjectRef getEntries = getObjectProperty(context, performance, "getEntries");
+    if (getEntries && !JSObjectIsFunction(context, getEntries))
+        getEntries = nullptr;
+
+    handles.context = JSGlobalContextRetain(context);
+    handles.performance = performance;
+    JSValueProtect(context, performance);
+    handles.getEntries = getEntries;
+    if (getEntries)
+        JSValueProtect(context, getEntries);
+
+    JSObjectRef getEntriesByType = getObjectProperty(context, performance, "getEntriesByType");
+    if (getEntriesByType && JSObjectIsFunction(context, getEntriesByType))
+    {
+        handles.getEntriesByType = getEntriesByType;
+        JSValueProtect(context, getEntriesByType);
+    }
+
+    captureTiming(context, handles);
+    observeLongTasks(context);
+}
+
+void willDestroyPage(WKBundlePageRef page)
+{
+    auto it = g_pages.find(page);
+    if (it == g_pages.end())
+        return;
+    if (it->second.pushTag)
+        g_source_remove(it->second.pushTag);
+    it->second.performance.clear();
+    g_pages.erase(it);
 }
 
 };
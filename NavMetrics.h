@@ -21,6 +21,7 @@
 
 #include <WebKit/WKBundlePage.h>
 #include <WebKit/WKBundleFrame.h>
+#include <WebKit/WKBundleScriptWorld.h>
 #include <WebKit/WKString.h>
 #include <WebKit/WKType.h>
 
@@ -29,6 +30,12 @@ namespace NavMetrics
 
 bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody);
 void didHandleOnloadEventsForFrame(WKBundlePageRef page, WKBundleFrameRef frame);
+void didStartProvisionalLoadForFrame(WKBundlePageRef page, WKBundleFrameRef frame);
+void didFirstLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame);
+void didFirstVisuallyNonEmptyLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame);
+void didLayoutForFrame(WKBundlePageRef page, WKBundleFrameRef frame);
+void didClearWindowObjectForFrame(WKBundlePageRef page, WKBundleFrameRef frame, WKBundleScriptWorldRef world);
+void willDestroyPage(WKBundlePageRef page);
 
 };
 
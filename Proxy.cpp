@@ -18,6 +18,8 @@
 */
 #include "Proxy.h"
 #include "JavaScriptRequests.h"
+#include "NativeServiceManager.h"
+#include "ScriptCache.h"
 #include "utils.h"
 #include "logger.h"
 
@@ -27,7 +29,8 @@
 #include <WebKit/WKURL.h>
 #include <WebKit/WKNumber.h>
 #include <WebKit/WKRetainPtr.h>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
 
 namespace JSBridge
 {
@@ -53,21 +56,18 @@ void injectWPEQuery(JSGlobalContextRef context)
     }
 }
 
-void injectServiceManager(JSGlobalContextRef context)
+void injectScriptServiceManager(JSContextRef context)
 {
     JSObjectRef windowObject = JSContextGetGlobalObject(context);
     JSRetainPtr<JSStringRef> serviceManagerStr = adopt(JSStringCreateWithUTF8CString("ServiceManager"));
 
     const char* jsFile = "/usr/share/injectedbundle/ServiceManager.js";
-    std::string content;
-    if (!Utils::readFile(jsFile, content))
+    JSValueRef exc = 0;
+    if (!ScriptCache::singleton().evaluate(context, jsFile, &exc))
     {
         RDKLOG_ERROR("Error: Could not read file %s!", jsFile);
         return;
     }
-
-    JSValueRef exc = 0;
-    (void) Utils::evaluateUserScript(context, content, &exc);
     if (exc)
     {
         RDKLOG_ERROR("Could not evaluate user script %s!", jsFile);
@@ -100,6 +100,41 @@ void injectServiceManager(JSGlobalContextRef context)
     }
 }
 
+// Getter of the lazy window.ServiceManager accessor.
+// Replaces itself with the real object on first access.
+JSValueRef onServiceManagerFirstAccess(
+    JSContextRef ctx,
+    JSObjectRef,
+    JSObjectRef,
+    size_t,
+    const JSValueRef*,
+    JSValueRef* exc)
+{
+    JSObjectRef windowObject = JSContextGetGlobalObject(ctx);
+    JSRetainPtr<JSStringRef> serviceManagerStr = adopt(JSStringCreateWithUTF8CString("ServiceManager"));
+
+    // The accessor has no setter, so it must be gone before
+    // ServiceManager.js assigns window.ServiceManager.
+    (void) JSObjectDeleteProperty(ctx, windowObject, serviceManagerStr.get(), nullptr);
+
+    RDKLOG_INFO("First access to ServiceManager, injecting it");
+    Proxy::singleton().injectServiceManager(ctx);
+
+    return JSObjectGetProperty(ctx, windowObject, serviceManagerStr.get(), exc);
+}
+
+void injectLazyServiceManager(JSGlobalContextRef context)
+{
+    // No page script has run yet, so the global Object is the built-in one.
+    JSRetainPtr<JSStringRef> getStr = adopt(JSStringCreateWithUTF8CString("get"));
+    JSObjectRef getter = JSObjectMakeFunctionWithCallback(context, getStr.get(), onServiceManagerFirstAccess);
+    if (!Utils::defineLazyGetter(context, "ServiceManager", getter))
+    {
+        RDKLOG_ERROR("Could not define lazy ServiceManager, injecting it now");
+        Proxy::singleton().injectServiceManager(context);
+    }
+}
+
 } // namespace
 
 struct QueryCallbacks
@@ -127,6 +162,19 @@ struct QueryCallbacks
 
 Proxy::Proxy()
 {
+    const char* lazy = getenv("ENABLE_LAZY_SERVICE_MANAGER");
+    if (lazy && strcmp(lazy, "1") == 0)
+    {
+        RDKLOG_INFO("ServiceManager will be injected on first access");
+        m_lazyServiceManager = true;
+    }
+
+    const char* native = getenv("ENABLE_NATIVE_SERVICE_MANAGER");
+    if (native && strcmp(native, "1") == 0)
+    {
+        RDKLOG_INFO("Using native ServiceManager");
+        m_nativeServiceManager = true;
+    }
 }
 
 void Proxy::didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
@@ -140,15 +188,56 @@ void Proxy::didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
     // Always inject wpeQuery and ServiceManager to be visible in JavaScript.
     auto context = WKBundleFrameGetJavaScriptContext(frame);
     injectWPEQuery(context);
-    injectServiceManager(context);
+    if (m_lazyServiceManager)
+        injectLazyServiceManager(context);
+    else
+        injectServiceManager(context);
+}
+
+void Proxy::injectServiceManager(JSContextRef context)
+{
+    if (!m_nativeServiceManager)
+    {
+        injectScriptServiceManager(context);
+        return;
+    }
+
+    if (!injectNativeServiceManager(context))
+    {
+        RDKLOG_WARNING("Native ServiceManager unavailable, using ServiceManager.js");
+        injectScriptServiceManager(context);
+        return;
+    }
+
+    // Keep ServiceManager.sendQuery for pages that call it directly.
+    JSObjectRef windowObject = JSContextGetGlobalObject(context);
+    JSRetainPtr<JSStringRef> serviceManagerStr = adopt(JSStringCreateWithUTF8CString("ServiceManager"));
+    JSValueRef smObject = JSObjectGetProperty(context, windowObject, serviceManagerStr.get(), nullptr);
+
+    JSRetainPtr<JSStringRef> sendQueryStr = adopt(JSStringCreateWithUTF8CString("sendQuery"));
+    JSValueRef sendQueryObject = JSObjectMakeFunctionWithCallback(context,
+        sendQueryStr.get(), JSBridge::onJavaScriptServiceManagerRequest);
+
+    JSValueRef exc = 0;
+    JSObjectSetProperty(context, (JSObjectRef) smObject, sendQueryStr.get(), sendQueryObject,
+        kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontDelete | kJSPropertyAttributeDontEnum, &exc);
+
+    if (exc)
+    {
+        RDKLOG_ERROR("Could not set property ServiceManager.sendQuery!");
+    }
 }
 
 void Proxy::sendQuery(const char* name, JSContextRef ctx,
     JSStringRef messageRef, JSValueRef onSuccess, JSValueRef onError)
 {
     WKRetainPtr<WKStringRef> mesRef = adoptWK(WKStringCreateWithJSString(messageRef));
-    std::string message = Utils::toStdString(mesRef.get());
+    sendQuery(name, ctx, Utils::toStdString(mesRef.get()), onSuccess, onError);
+}
 
+void Proxy::sendQuery(const char* name, JSContextRef ctx,
+    const std::string& message, JSValueRef onSuccess, JSValueRef onError)
+{
     uint64_t callID = 0;
     if (!JSValueIsNull(ctx, onSuccess) || !JSValueIsNull(ctx, onError))
     {
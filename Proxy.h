@@ -62,6 +62,13 @@ public:
     void sendQuery(const char* name, JSContextRef ctx, JSStringRef messageRef,
         JSValueRef onSuccess, JSValueRef onError);
 
+    /**
+     * @copydoc sendQuery
+     * Takes already serialized message.
+     */
+    void sendQuery(const char* name, JSContextRef ctx, const std::string& message,
+        JSValueRef onSuccess, JSValueRef onError);
+
     /**
      * After each sendQuery response message should be sent back.
      * Called when the response is received.
@@ -73,6 +80,11 @@ public:
      */
     void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame);
 
+    /**
+     * Injects window.ServiceManager, either native or from ServiceManager.js.
+     */
+    void injectServiceManager(JSContextRef context);
+
     /**
      * Release protected resources
      */
@@ -114,6 +126,18 @@ private:
      * to proper handling responses.
      */
     uint64_t m_lastCallID = {0};
+
+    /**
+     * Defer ServiceManager evaluation until page reads window.ServiceManager.
+     * Enabled with ENABLE_LAZY_SERVICE_MANAGER=1.
+     */
+    bool m_lazyServiceManager = {false};
+
+    /**
+     * Use native ServiceManager instead of ServiceManager.js.
+     * Enabled with ENABLE_NATIVE_SERVICE_MANAGER=1.
+     */
+    bool m_nativeServiceManager = {false};
 };
 
 } // namespace JSBridge
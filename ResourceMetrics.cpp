@@ -0,0 +1,225 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ResourceMetrics.h"
+#include "Histogram.h"
+#include "logger.h"
+#include "utils.h"
+
+#include <WebKit/WKArray.h>
+#include <WebKit/WKNumber.h>
+#include <WebKit/WKRetainPtr.h>
+#include <WebKit/WKURL.h>
+
+#include <glib.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace ResourceMetrics
+{
+
+namespace
+{
+
+// Hosts tracked per page, the rest is counted under kOtherHost.
+const size_t kMaxHosts = 64;
+const char kOtherHost[] = "(other)";
+
+struct HostStats
+{
+    // Microseconds from initiate to response, and to finish.
+    Histogram firstByte;
+    Histogram total;
+    // Bytes per second of finished loads that had a body.
+    Histogram throughput;
+    Histogram bytes;
+    uint64_t failures { 0 };
+    uint64_t httpErrors { 0 };
+};
+
+struct Load
+{
+    HostStats* host;
+    int64_t start;
+    int64_t firstByte;
+    uint64_t bytes;
+};
+
+struct PageResources
+{
+    // In flight loads, entries are dropped when the load ends.
+    std::unordered_map<uint64_t, Load> loads;
+    std::unordered_map<std::string, HostStats> hosts;
+};
+
+std::unordered_map<WKBundlePageRef, PageResources> g_pages;
+
+HostStats* hostStats(PageResources& resources, WKURLRequestRef request)
+{
+    std::string host;
+    WKRetainPtr<WKURLRef> url = adoptWK(WKURLRequestCopyURL(request));
+    if (url)
+    {
+        WKRetainPtr<WKStringRef> hostName = adoptWK(WKURLCopyHostName(url.get()));
+        if (hostName)
+            host = Utils::toStdString(hostName.get());
+    }
+
+    auto it = resources.hosts.find(host);
+    if (it == resources.hosts.end())
+    {
+        if (resources.hosts.size() >= kMaxHosts)
+            host = kOtherHost;
+        it = resources.hosts.emplace(std::move(host), HostStats()).first;
+    }
+    return &it->second;
+}
+
+Load* findLoad(WKBundlePageRef page, uint64_t resourceIdentifier)
+{
+    auto pageIt = g_pages.find(page);
+    if (pageIt == g_pages.end())
+        return nullptr;
+    auto it = pageIt->second.loads.find(resourceIdentifier);
+    return it != pageIt->second.loads.end() ? &it->second : nullptr;
+}
+
+void endLoad(WKBundlePageRef page, uint64_t resourceIdentifier, bool failed)
+{
+    auto pageIt = g_pages.find(page);
+    if (pageIt == g_pages.end())
+        return;
+    auto it = pageIt->second.loads.find(resourceIdentifier);
+    if (it == pageIt->second.loads.end())
+        return;
+
+    const Load& load = it->second;
+    HostStats& host = *load.host;
+    if (failed)
+    {
+        ++host.failures;
+    }
+    else
+    {
+        int64_t duration = g_get_monotonic_time() - load.start;
+        if (load.firstByte)
+            host.firstByte.add(load.firstByte - load.start);
+        host.total.add(duration);
+        host.bytes.add(load.bytes);
+        if (load.bytes && duration > 0)
+            host.throughput.add(load.bytes * static_cast<double>(G_USEC_PER_SEC) / duration);
+    }
+
+    pageIt->second.loads.erase(it);
+}
+
+std::string toJSON(const PageResources& resources)
+{
+    std::string json = "{\"inFlight\":" + std::to_string(resources.loads.size()) + ",\"hosts\":{";
+    bool first = true;
+    for (const auto& it : resources.hosts)
+    {
+        const HostStats& host = it.second;
+        if (!first)
+            json += ',';
+        first = false;
+        Utils::appendJSONString(json, it.first);
+        json += ":{\"firstByteUs\":";
+        host.firstByte.appendJSON(json);
+        json += ",\"totalUs\":";
+        host.total.appendJSON(json);
+        json += ",\"bytesPerSecond\":";
+        host.throughput.appendJSON(json);
+        json += ",\"bytes\":";
+        host.bytes.appendJSON(json);
+        json += ",\"failures\":" + std::to_string(host.failures);
+        json += ",\"httpErrors\":" + std::to_string(host.httpErrors);
+        json += '}';
+    }
+    json += "}}";
+    return json;
+}
+
+} // namespace
+
+void didInitiateLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier, WKURLRequestRef request)
+{
+    PageResources& resources = g_pages[page];
+    Load load { hostStats(resources, request), g_get_monotonic_time(), 0, 0 };
+    resources.loads[resourceIdentifier] = load;
+}
+
+void didReceiveResponseForResource(WKBundlePageRef page, uint64_t resourceIdentifier, WKURLResponseRef response)
+{
+    Load* load = findLoad(page, resourceIdentifier);
+    if (!load)
+        return;
+    if (!load->firstByte)
+        load->firstByte = g_get_monotonic_time();
+    if (response && WKURLResponseHTTPStatusCode(response) >= 400)
+        ++load->host->httpErrors;
+}
+
+void didReceiveContentLengthForResource(WKBundlePageRef page, uint64_t resourceIdentifier, uint64_t contentLength)
+{
+    Load* load = findLoad(page, resourceIdentifier);
+    if (load)
+        load->bytes += contentLength;
+}
+
+void didFinishLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier)
+{
+    endLoad(page, resourceIdentifier, false);
+}
+
+void didFailLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier)
+{
+    endLoad(page, resourceIdentifier, true);
+}
+
+void removePage(WKBundlePageRef page)
+{
+    g_pages.erase(page);
+}
+
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
+{
+    if (!WKStringIsEqualToUTF8CString(messageName, "getResourceMetrics"))
+        return false;
+
+    if (WKGetTypeID(messageBody) != WKUInt64GetTypeID())
+    {
+        RDKLOG_ERROR("Unexpected param type.");
+        return true;
+    }
+
+    std::string metrics = toJSON(g_pages[page]);
+    RDKLOG_TRACE("Return resource metrics: '%s'", metrics.c_str());
+
+    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onResourceMetrics"));
+    WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(metrics.c_str()));
+
+    WKTypeRef params[] = {messageBody, bodyRef.get()};
+    WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+
+    WKBundlePagePostMessage(page, nameRef.get(), arrRef.get());
+    return true;
+}
+
+} // namespace ResourceMetrics
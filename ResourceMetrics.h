@@ -0,0 +1,52 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef RESOURCEMETRICS_H
+#define RESOURCEMETRICS_H
+
+#include <WebKit/WKBundlePage.h>
+#include <WebKit/WKString.h>
+#include <WebKit/WKType.h>
+#include <WebKit/WKURLRequest.h>
+#include <WebKit/WKURLResponse.h>
+
+#include <stdint.h>
+
+/**
+ * Per-page resource load timing, aggregated per host.
+ * Fed from the page resource load client.
+ */
+namespace ResourceMetrics
+{
+
+void didInitiateLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier, WKURLRequestRef request);
+void didReceiveResponseForResource(WKBundlePageRef page, uint64_t resourceIdentifier, WKURLResponseRef response);
+void didReceiveContentLengthForResource(WKBundlePageRef page, uint64_t resourceIdentifier, uint64_t contentLength);
+void didFinishLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier);
+void didFailLoadForResource(WKBundlePageRef page, uint64_t resourceIdentifier);
+
+void removePage(WKBundlePageRef page);
+
+/**
+ * Handles "getResourceMetrics" (UInt64 id), answered with "onResourceMetrics".
+ */
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody);
+
+};
+
+#endif // RESOURCEMETRICS_H
@@ -0,0 +1,232 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "ScriptCache.h"
+#include "logger.h"
+#include "utils.h"
+
+#ifdef HAVE_JSC_SCRIPT_REF
+#include <JavaScriptCore/JSContextRef.h>
+#include <JavaScriptCore/JSScriptRefPrivate.h>
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <algorithm>
+
+namespace JSBridge
+{
+
+struct CompiledScript
+{
+#ifdef HAVE_JSC_SCRIPT_REF
+    explicit CompiledScript(JSContextGroupRef group)
+        : group(JSContextGroupRetain(group))
+    {
+    }
+
+    ~CompiledScript()
+    {
+        if (script)
+            JSScriptRelease(script);
+        JSContextGroupRelease(group);
+    }
+
+    JSContextGroupRef group;
+    JSScriptRef script = nullptr;
+    // Set when parsing failed, kept until the file changes.
+    JSRetainPtr<JSStringRef> errorMessage;
+    int64_t parseUs = 0;
+    int64_t firstEvalUs = -1;
+#endif
+};
+
+namespace
+{
+
+// Scripts are only replaced on firmware update or by developers,
+// so there is no need to stat them on every navigation.
+const int64_t kRevalidateIntervalUs = 5 * G_USEC_PER_SEC;
+
+ScriptAssetPtr loadAsset(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    std::string content;
+    if (st.st_size > 0)
+    {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return nullptr;
+        }
+        // JSC and WK string constructors require a null-terminated buffer,
+        // which the mapping doesn't guarantee.
+        content.assign(static_cast<const char*>(data), st.st_size);
+        munmap(data, st.st_size);
+    }
+    close(fd);
+
+    auto asset = std::make_shared<ScriptAsset>();
+    asset->path = path;
+    asset->jsSource = adopt(JSStringCreateWithUTF8CString(content.c_str()));
+    asset->wkSource = adoptWK(WKStringCreateWithUTF8CString(content.c_str()));
+    asset->mtime = st.st_mtim.tv_sec;
+    asset->mtimeNsec = st.st_mtim.tv_nsec;
+
+    RDKLOG_INFO("Loaded %s (%ld bytes)", path, static_cast<long>(st.st_size));
+    return asset;
+}
+
+} // namespace
+
+ScriptCache& ScriptCache::singleton()
+{
+    static ScriptCache& singleton = *new ScriptCache();
+    return singleton;
+}
+
+ScriptCache::Entry* ScriptCache::lookup(const char* path)
+{
+    int64_t now = g_get_monotonic_time();
+
+    auto it = m_assets.find(path);
+    if (it != m_assets.end())
+    {
+        Entry& entry = it->second;
+        if (now - entry.lastCheck < kRevalidateIntervalUs)
+            return &entry;
+
+        entry.lastCheck = now;
+
+        struct stat st;
+        if (stat(path, &st) != 0)
+        {
+            RDKLOG_WARNING("Could not stat %s, using cached copy", path);
+            return &entry;
+        }
+
+        if (st.st_mtim.tv_sec == entry.asset->mtime && st.st_mtim.tv_nsec == entry.asset->mtimeNsec)
+            return &entry;
+
+        RDKLOG_INFO("%s was modified, reloading", path);
+        ScriptAssetPtr asset = loadAsset(path);
+        if (asset)
+        {
+            entry.asset = asset;
+            entry.compiled.reset();
+        }
+        return &entry;
+    }
+
+    ScriptAssetPtr asset = loadAsset(path);
+    if (!asset)
+        return nullptr;
+
+    Entry& entry = m_assets[path];
+    entry.asset = asset;
+    entry.lastCheck = now;
+    return &entry;
+}
+
+ScriptAssetPtr ScriptCache::get(const char* path)
+{
+    Entry* entry = lookup(path);
+    return entry ? entry->asset : nullptr;
+}
+
+bool ScriptCache::evaluate(JSContextRef context, const char* path, JSValueRef* exc)
+{
+    Entry* entry = lookup(path);
+    if (!entry)
+        return false;
+
+#ifdef HAVE_JSC_SCRIPT_REF
+    JSContextGroupRef group = JSContextGetGroup(context);
+    if (!entry->compiled || entry->compiled->group != group)
+    {
+        auto compiled = std::make_shared<CompiledScript>(group);
+
+        JSRetainPtr<JSStringRef> url = adopt(JSStringCreateWithUTF8CString(path));
+        JSStringRef errorMessage = nullptr;
+        int errorLine = 0;
+
+        int64_t start = g_get_monotonic_time();
+        compiled->script = JSScriptCreateFromString(group, url.get(), 1,
+            entry->asset->jsSource.get(), &errorMessage, &errorLine);
+        compiled->parseUs = g_get_monotonic_time() - start;
+
+        if (!compiled->script)
+        {
+            RDKLOG_ERROR("Could not parse %s, line %d", path, errorLine);
+            compiled->errorMessage = errorMessage
+                ? adopt(errorMessage) : adopt(JSStringCreateWithUTF8CString("Syntax error"));
+        }
+
+        entry->compiled = compiled;
+    }
+
+    CompiledScript& compiled = *entry->compiled;
+
+    if (!compiled.script)
+    {
+        // Report the cached parse error without parsing the file again.
+        if (exc)
+            *exc = Utils::makeError(context, "SyntaxError", compiled.errorMessage.get());
+        return true;
+    }
+
+    int64_t start = g_get_monotonic_time();
+    (void) JSScriptEvaluate(context, compiled.script, nullptr, exc);
+    int64_t evalUs = g_get_monotonic_time() - start;
+
+    if (compiled.firstEvalUs < 0)
+    {
+        compiled.firstEvalUs = evalUs;
+        RDKLOG_INFO("%s: parsed in %lld us, first evaluation took %lld us", path,
+            static_cast<long long>(compiled.parseUs), static_cast<long long>(evalUs));
+    }
+    else
+    {
+        int64_t saved = compiled.parseUs + std::max<int64_t>(0, compiled.firstEvalUs - evalUs);
+        RDKLOG_TRACE("%s: evaluated in %lld us, about %lld us of parse/compile saved", path,
+            static_cast<long long>(evalUs), static_cast<long long>(saved));
+    }
+#else
+    (void) Utils::evaluateUserScript(context, entry->asset->jsSource.get(), exc);
+#endif
+
+    return true;
+}
+
+} // namespace JSBridge
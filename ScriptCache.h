@@ -0,0 +1,99 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef JSBRIDGE_SCRIPT_CACHE_H
+#define JSBRIDGE_SCRIPT_CACHE_H
+
+#include <JavaScriptCore/JSRetainPtr.h>
+#include <JavaScriptCore/JSStringRef.h>
+#include <JavaScriptCore/JSValueRef.h>
+#include <WebKit/WKRetainPtr.h>
+#include <WebKit/WKString.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace JSBridge
+{
+
+/**
+ * Immutable content of an injected script file.
+ */
+struct ScriptAsset
+{
+    std::string path;
+    JSRetainPtr<JSStringRef> jsSource;
+    WKRetainPtr<WKStringRef> wkSource;
+    time_t mtime;
+    long mtimeNsec;
+};
+
+typedef std::shared_ptr<const ScriptAsset> ScriptAssetPtr;
+
+/**
+ * Compiled form of a script, defined by the JSC backend in use.
+ */
+struct CompiledScript;
+
+/**
+ * Keeps injected scripts in memory so that navigations don't hit the file system.
+ * Each file is read once and re-read only when its mtime changes.
+ */
+class ScriptCache
+{
+public:
+    static ScriptCache& singleton();
+
+    /**
+     * Returns cached script, loading it on first use.
+     * The file's mtime is checked at most once per revalidation interval.
+     * @return nullptr if the script could not be loaded.
+     */
+    ScriptAssetPtr get(const char* path);
+
+    /**
+     * Evaluates cached script in specific JavaScript context.
+     * If JSC provides JSScriptRef, the script is parsed once per context group
+     * and its compiled code is shared by every global object of the group.
+     * A parse failure is cached as well and reported as a SyntaxError until the file changes.
+     * @return false if the script could not be loaded.
+     */
+    bool evaluate(JSContextRef context, const char* path, JSValueRef* exc);
+
+private:
+    ScriptCache() {}
+    ScriptCache(const ScriptCache&) = delete;
+    ScriptCache& operator=(const ScriptCache&) = delete;
+
+    struct Entry
+    {
+        ScriptAssetPtr asset;
+        std::shared_ptr<CompiledScript> compiled;
+        int64_t lastCheck;
+    };
+
+    Entry* lookup(const char* path);
+
+    std::unordered_map<std::string, Entry> m_assets;
+};
+
+} // namespace JSBridge
+
+#endif // JSBRIDGE_SCRIPT_CACHE_H
@@ -17,12 +17,149 @@
  * limitations under the License.
  */
 
+#include "JavaScriptAsyncFunctionType.h"
 #include "JavaScriptFunctionType.h"
+#include "SecurityAgent.h"
+#include "WorkerPool.h"
 #include <securityagent.h>
 #include <string.h>
+#include <glib.h>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include "logger.h"
 #include "utils.h"
 
+namespace {
+
+    // Tokens per URL. Filled from the main thread and from workers.
+    class TokenCache {
+    public:
+        static TokenCache& singleton()
+        {
+            static TokenCache& singleton = *new TokenCache();
+            return singleton;
+        }
+
+        bool lookup(const std::string& url, std::string& token)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _tokens.find(url);
+            if (it == _tokens.end())
+                return false;
+            if (g_get_monotonic_time() >= it->second.expiry) {
+                _tokens.erase(it);
+                return false;
+            }
+            token = it->second.token;
+            return true;
+        }
+
+        // Generation to pass to store(), taken before the token is requested.
+        uint64_t generation()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _generation;
+        }
+
+        // Tokens requested before a remove() are not cached, they may belong to the previous page.
+        void store(const std::string& url, const std::string& token, uint64_t generation)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            markUsedLocked(url);
+            _pending.erase(url);
+            if (_ttlUs > 0 && !token.empty() && generation == _generation)
+                _tokens[url] = Entry { token, g_get_monotonic_time() + _ttlUs };
+        }
+
+        // Returns true if url asked for a token before and a prefetch isn't running yet.
+        bool startPrefetch(const std::string& url, uint64_t& generation)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_ttlUs <= 0 || !_used.count(url) || _pending.count(url))
+                return false;
+            auto it = _tokens.find(url);
+            if (it != _tokens.end() && g_get_monotonic_time() < it->second.expiry)
+                return false;
+            _pending.insert(url);
+            generation = _generation;
+            return true;
+        }
+
+        void remove(const std::string& url)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tokens.erase(url);
+            _pending.erase(url);
+            ++_generation;
+        }
+
+    private:
+        TokenCache()
+        {
+            // Tokens are valid much longer, this only bounds how stale a cached one can get.
+            int ttlSeconds = 300;
+            const char* s = getenv("WPE_TOKEN_CACHE_TTL");
+            if (s)
+                ttlSeconds = atoi(s);
+            _ttlUs = static_cast<int64_t>(ttlSeconds) * G_USEC_PER_SEC;
+            RDKLOG_INFO("Token cache TTL: %d seconds", ttlSeconds);
+        }
+
+        struct Entry {
+            std::string token;
+            int64_t expiry;
+        };
+
+        static const size_t kMaxUsed = 64;
+
+        void markUsedLocked(const std::string& url)
+        {
+            if (!_used.insert(url).second)
+                return;
+            _usedOrder.push_back(url);
+            if (_usedOrder.size() > kMaxUsed) {
+                _used.erase(_usedOrder.front());
+                _usedOrder.pop_front();
+            }
+        }
+
+        std::mutex _mutex;
+        int64_t _ttlUs;
+        std::unordered_map<std::string, Entry> _tokens;
+        // URLs that asked for a token, candidates for prefetch. Oldest are dropped first.
+        std::unordered_set<std::string> _used;
+        std::deque<std::string> _usedOrder;
+        std::unordered_set<std::string> _pending;
+        uint64_t _generation {0};
+    };
+
+    // Blocking round trip to SecurityAgent.
+    std::string requestToken(const std::string& url) {
+        uint8_t buffer[2 * 1024];
+
+        std::string tokenAsString;
+        if (url.length() < sizeof(buffer)) {
+            ::memset (buffer, 0, sizeof(buffer));
+            ::memcpy (buffer, url.c_str(), url.length());
+
+            int length = GetToken(static_cast<uint16_t>(sizeof(buffer)), url.length(), buffer);
+            if (length > 0) {
+               tokenAsString = std::string(reinterpret_cast<const char*>(buffer), length);
+            }
+        }
+
+        return (tokenAsString);
+    }
+
+    std::string requestAndCacheToken(const std::string& url, uint64_t generation) {
+        std::string token = requestToken(url);
+        TokenCache::singleton().store(url, token, generation);
+        return token;
+    }
+}
+
 namespace WPEFramework {
 namespace JavaScript {
     namespace Functions {
@@ -35,41 +172,81 @@ namespace JavaScript {
             ~token() {
             }
 
+            // Hand-written, unlike tokenAsync: arguments are not an error here, existing callers rely on that.
             JSValueRef HandleMessage(JSContextRef context, JSObjectRef,
-                JSObjectRef, size_t argumentCount, const JSValueRef arguments[], JSValueRef*) {
-                JSValueRef result;
-
-                (void) arguments;
+                JSObjectRef, size_t argumentCount, const JSValueRef[], JSValueRef*) {
                 if (argumentCount != 0) {
                     RDKLOG_INFO("The Token Javascript command, does not take any paramaters!!!");
-                    result = JSValueMakeNull(context);
+                    return JSValueMakeNull(context);
                 }
-                else {
-                    uint8_t buffer[2 * 1024];
 
-                    std::string url = Utils::GetURL();
-                    std::string tokenAsString;
-                    if (url.length() < sizeof(buffer)) {
-                        ::memset (buffer, 0, sizeof(buffer));
-                        ::memcpy (buffer, url.c_str(), url.length());
+                Utils::SharedURL url = Utils::GetURL(context);
+                std::string tokenAsString;
+                if (url && !TokenCache::singleton().lookup(*url, tokenAsString))
+                    tokenAsString = requestAndCacheToken(*url, TokenCache::singleton().generation());
 
-                        int length = GetToken(static_cast<uint16_t>(sizeof(buffer)), url.length(), buffer);
-                        if (length > 0) {
-                           tokenAsString = std::string(reinterpret_cast<const char*>(buffer), length);
-                        }
-                    }
+                JSStringRef returnMessage = JSStringCreateWithUTF8CString(tokenAsString.c_str());
+                JSValueRef result = JSValueMakeString(context, returnMessage);
+                JSStringRelease(returnMessage);
+                return (result);
+            }
+        };
 
-                    JSStringRef returnMessage = JSStringCreateWithUTF8CString(tokenAsString.c_str());
-                    result = JSValueMakeString(context, returnMessage);
+        // thunder.tokenAsync() returns a Promise, SecurityAgent is queried on a worker thread.
+        class tokenAsync {
+        public:
+            tokenAsync(const tokenAsync&) = delete;
+            tokenAsync& operator= (const tokenAsync&) = delete;
+            tokenAsync() {
+            }
+            ~tokenAsync() {
+            }
 
-                    JSStringRelease(returnMessage);
+            std::function<std::string()> Call(JSContextRef context) {
+                Utils::SharedURL url = Utils::GetURL(context);
+                std::string token;
+                if (!url || TokenCache::singleton().lookup(*url, token)) {
+                    return [token]() {
+                        return token;
+                    };
                 }
-
-                return (result);
+                // The URL is immutable and shared, the worker keeps its own reference.
+                uint64_t generation = TokenCache::singleton().generation();
+                return [url, generation]() {
+                    return requestAndCacheToken(*url, generation);
+                };
             }
         };
 
         static JavaScriptFunctionType<token> _instance("thunder", "token");
+        static AsyncJavaScriptFunctionType<tokenAsync> _asyncInstance("thunder", "tokenAsync");
     }
 }
 }
+
+namespace SecurityAgent
+{
+
+void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame)
+{
+    if (WKBundlePageGetMainFrame(page) != frame)
+        return;
+
+    // Same key as thunder.token() lookups, published by the bundle before this call.
+    Utils::SharedURL url = Utils::GetURL(page);
+    uint64_t generation;
+    if (!url || !TokenCache::singleton().startPrefetch(*url, generation))
+        return;
+
+    RDKLOG_INFO("Prefetching token");
+    WorkerPool::run([url, generation]() {
+        (void) requestAndCacheToken(*url, generation);
+    }, nullptr);
+}
+
+void didChangeURL(const std::string& previousUrl)
+{
+    TokenCache::singleton().remove(previousUrl);
+}
+
+} // namespace SecurityAgent
@@ -0,0 +1,43 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SECURITYAGENT_H
+#define SECURITYAGENT_H
+
+#include <WebKit/WKBundlePage.h>
+#include <WebKit/WKBundleFrame.h>
+
+#include <string>
+
+namespace SecurityAgent
+{
+
+/**
+ * Prefetches token on a worker thread if the committed URL asked for one before.
+ */
+void didCommitLoad(WKBundlePageRef page, WKBundleFrameRef frame);
+
+/**
+ * Drops the cached token of the URL a page navigated away from.
+ */
+void didChangeURL(const std::string& previousUrl);
+
+};
+
+#endif // SECURITYAGENT_H
@@ -49,23 +49,6 @@ void initialize()
     }
 }
 
-static std::string jsToStdString(JSStringRef jsStr)
-{
-    if (!jsStr)
-        return {};
-
-    size_t len = JSStringGetMaximumUTF8CStringSize(jsStr);
-    if (!len)
-        return {};
-
-    std::unique_ptr<char[]> buffer(new char[len]);
-    len = JSStringGetUTF8CString(jsStr, buffer.get(), len);
-    if (!len)
-        return {};
-
-    return std::string {buffer.get(), len};
-}
-
 void didFocusTextField(WKBundlePageRef page, WKBundleFrameRef frame)
 {
     if(!enableVirtualKeyboard) {
@@ -81,7 +64,7 @@ void didFocusTextField(WKBundlePageRef page, WKBundleFrameRef frame)
     if(!jsResultStr)
         return;
 
-    std::string result = jsToStdString(jsResultStr);
+    std::string result = Utils::toStdString(jsResultStr);
     JSStringRelease(jsResultStr);
 
     WKStringRef messageNameRef = WKStringCreateWithUTF8CString("didFocusTextField");
@@ -0,0 +1,195 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "Watchdog.h"
+#include "Histogram.h"
+#include "logger.h"
+
+#include <WebKit/WKArray.h>
+#include <WebKit/WKNumber.h>
+#include <WebKit/WKRetainPtr.h>
+
+#include <glib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+#include <string>
+
+namespace Watchdog
+{
+
+namespace
+{
+
+const char* const kCallbackNames[CallbackCount] = {
+    "didStartProvisionalLoadForFrame",
+    "didCommitLoadForFrame",
+    "didSameDocumentNavigationForFrame",
+    "didFirstLayoutForFrame",
+    "didFirstVisuallyNonEmptyLayoutForFrame",
+    "didClearWindowObjectForFrame",
+    "didHandleOnloadEventsForFrame",
+    "didLayoutForFrame",
+    "shouldGoToBackForwardListItem",
+    "didInitiateLoadForResource",
+    "willSendRequestForFrame",
+    "didReceiveResponseForResource",
+    "didReceiveContentLengthForResource",
+    "didFinishLoadForResource",
+    "didFailLoadForResource",
+    "decidePolicyForNavigationAction",
+    "didFocusTextField",
+    "didCreatePage",
+    "willDestroyPage",
+    "didReceiveMessageToPage",
+};
+
+// Callback the main thread is in and when it entered, packed so the
+// watchdog thread reads a consistent pair: entry time << 8 | (callback + 1).
+int64_t pack(int callback, int64_t enteredAt)
+{
+    return (enteredAt << 8) | (callback + 1);
+}
+
+int64_t envValue(const char* name, int64_t defaultValue)
+{
+    const char* s = getenv(name);
+    return s ? atoll(s) : defaultValue;
+}
+
+struct State
+{
+    State()
+        : budgetUs(envValue("WPE_CALLBACK_BUDGET_US", 16000))
+        , stallUs(envValue("WPE_WATCHDOG_STALL_MS", 0) * 1000)
+    {
+        if (stallUs > 0)
+            g_thread_unref(g_thread_new("BundleWatchdog", watch, this));
+    }
+
+    // Polls the callback the main thread is in and reports it once it stalls.
+    static gpointer watch(gpointer data)
+    {
+        State& self = *static_cast<State*>(data);
+        int64_t reportedEntry = 0;
+        for (;;)
+        {
+            g_usleep(std::max<int64_t>(self.stallUs / 4, 10000));
+
+            int64_t current = self.current.load(std::memory_order_relaxed);
+            int callback = static_cast<int>(current & 0xff) - 1;
+            int64_t enteredAt = current >> 8;
+            if (callback < 0 || enteredAt == reportedEntry)
+                continue;
+
+            int64_t elapsed = g_get_monotonic_time() - enteredAt;
+            if (elapsed >= self.stallUs)
+            {
+                reportedEntry = enteredAt;
+                RDKLOG_ERROR("Main thread stuck in %s for %lld ms",
+                    kCallbackNames[callback], static_cast<long long>(elapsed / 1000));
+            }
+        }
+        return nullptr;
+    }
+
+    int64_t budgetUs;
+    int64_t stallUs;
+    Histogram latency[CallbackCount];
+    uint64_t overBudget[CallbackCount] { };
+
+    // Read by the watchdog thread, see pack().
+    std::atomic<int64_t> current { 0 };
+};
+
+State& state()
+{
+    static State& state = *new State();
+    return state;
+}
+
+std::string toJSON()
+{
+    const State& s = state();
+    std::string json = "{\"budgetUs\":" + std::to_string(s.budgetUs) + ",\"callbacks\":{";
+    bool first = true;
+    for (int i = 0; i < CallbackCount; ++i)
+    {
+        if (!s.latency[i].count())
+            continue;
+        if (!first)
+            json += ',';
+        first = false;
+        json += std::string("\"") + kCallbackNames[i] + "\":{\"latencyUs\":";
+        s.latency[i].appendJSON(json);
+        json += ",\"overBudget\":" + std::to_string(s.overBudget[i]) + "}";
+    }
+    json += "}}";
+    return json;
+}
+
+} // namespace
+
+void enter(Callback callback, Entry& entry)
+{
+    State& s = state();
+    entry.enteredAt = g_get_monotonic_time();
+    entry.previous = s.current.exchange(pack(callback, entry.enteredAt), std::memory_order_relaxed);
+}
+
+void leave(Callback callback, const Entry& entry)
+{
+    State& s = state();
+    int64_t elapsed = g_get_monotonic_time() - entry.enteredAt;
+
+    // Nested callbacks, e.g. a message handler running JS that loads a resource.
+    s.current.store(entry.previous, std::memory_order_relaxed);
+
+    s.latency[callback].add(elapsed);
+    if (elapsed > s.budgetUs)
+    {
+        ++s.overBudget[callback];
+        RDKLOG_WARNING("%s took %lld us, budget %lld us", kCallbackNames[callback],
+            static_cast<long long>(elapsed), static_cast<long long>(s.budgetUs));
+    }
+}
+
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody)
+{
+    if (!WKStringIsEqualToUTF8CString(messageName, "getCallbackLatency"))
+        return false;
+
+    if (WKGetTypeID(messageBody) != WKUInt64GetTypeID())
+    {
+        RDKLOG_ERROR("Unexpected param type.");
+        return true;
+    }
+
+    std::string latency = toJSON();
+    WKRetainPtr<WKStringRef> nameRef = adoptWK(WKStringCreateWithUTF8CString("onCallbackLatency"));
+    WKRetainPtr<WKStringRef> bodyRef = adoptWK(WKStringCreateWithUTF8CString(latency.c_str()));
+
+    WKTypeRef params[] = {messageBody, bodyRef.get()};
+    WKRetainPtr<WKArrayRef> arrRef = adoptWK(WKArrayCreate(params, sizeof(params)/sizeof(params[0])));
+
+    WKBundlePagePostMessage(page, nameRef.get(), arrRef.get());
+    return true;
+}
+
+} // namespace Watchdog
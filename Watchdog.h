@@ -0,0 +1,104 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <WebKit/WKBundlePage.h>
+#include <WebKit/WKString.h>
+#include <WebKit/WKType.h>
+
+#include <stdint.h>
+
+/**
+ * Measures how long bundle callbacks hold the WebProcess main thread.
+ * Per-callback latency histograms, a log line for callbacks over budget
+ * (WPE_CALLBACK_BUDGET_US, 16 ms by default) and, if WPE_WATCHDOG_STALL_MS
+ * is set, a thread that reports a callback while it is still stuck.
+ */
+namespace Watchdog
+{
+
+enum Callback
+{
+    DidStartProvisionalLoadForFrame = 0,
+    DidCommitLoadForFrame,
+    DidSameDocumentNavigationForFrame,
+    DidFirstLayoutForFrame,
+    DidFirstVisuallyNonEmptyLayoutForFrame,
+    DidClearWindowObjectForFrame,
+    DidHandleOnloadEventsForFrame,
+    DidLayoutForFrame,
+    ShouldGoToBackForwardListItem,
+    DidInitiateLoadForResource,
+    WillSendRequestForFrame,
+    DidReceiveResponseForResource,
+    DidReceiveContentLengthForResource,
+    DidFinishLoadForResource,
+    DidFailLoadForResource,
+    DecidePolicyForNavigationAction,
+    DidFocusTextField,
+    DidCreatePage,
+    WillDestroyPage,
+    DidReceiveMessageToPage,
+    CallbackCount
+};
+
+struct Entry
+{
+    int64_t enteredAt;
+    // Callback this one is nested in, restored on leave.
+    int64_t previous;
+};
+
+void enter(Callback callback, Entry& entry);
+void leave(Callback callback, const Entry& entry);
+
+/**
+ * Times the enclosing callback.
+ */
+class Scope
+{
+public:
+    explicit Scope(Callback callback)
+        : m_callback(callback)
+    {
+        enter(m_callback, m_entry);
+    }
+
+    ~Scope()
+    {
+        leave(m_callback, m_entry);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Callback m_callback;
+    Entry m_entry;
+};
+
+/**
+ * Handles "getCallbackLatency" (UInt64 id), answered with "onCallbackLatency".
+ */
+bool didReceiveMessageToPage(WKBundlePageRef page, WKStringRef messageName, WKTypeRef messageBody);
+
+};
+
+#endif // WATCHDOG_H
@@ -0,0 +1,87 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include "WorkerPool.h"
+#include "logger.h"
+
+#include <glib.h>
+
+#include <cstdlib>
+
+namespace WorkerPool
+{
+
+namespace
+{
+
+// Work items are short IPC round trips, a couple of threads is enough.
+const int kDefaultThreadCount = 2;
+
+struct Job
+{
+    std::function<void()> work;
+    std::function<void()> done;
+};
+
+void runJob(gpointer data, gpointer)
+{
+    Job* job = static_cast<Job*>(data);
+
+    job->work();
+
+    if (!job->done)
+    {
+        delete job;
+        return;
+    }
+
+    g_main_context_invoke_full(g_main_context_default(), G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+        static_cast<Job*>(data)->done();
+        return G_SOURCE_REMOVE;
+    }, job, [](gpointer data) {
+        delete static_cast<Job*>(data);
+    });
+}
+
+GThreadPool* pool()
+{
+    static GThreadPool* gPool = [] {
+        int threads = kDefaultThreadCount;
+        const char* s = getenv("WPE_BUNDLE_WORKER_THREADS");
+        if (s && atoi(s) > 0)
+            threads = atoi(s);
+
+        RDKLOG_INFO("Starting %d bundle worker threads", threads);
+        return g_thread_pool_new(runJob, nullptr, threads, FALSE, nullptr);
+    }();
+    return gPool;
+}
+
+} // namespace
+
+void run(std::function<void()> work, std::function<void()> done)
+{
+    Job* job = new Job { std::move(work), std::move(done) };
+    if (!g_thread_pool_push(pool(), job, nullptr))
+    {
+        RDKLOG_ERROR("Could not queue job, running it on the calling thread");
+        runJob(job, nullptr);
+    }
+}
+
+} // namespace WorkerPool
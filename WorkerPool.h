@@ -0,0 +1,36 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <functional>
+
+namespace WorkerPool
+{
+
+/**
+ * Runs blocking work off the WebProcess main thread.
+ * @param Work to run on one of the bundle worker threads.
+ * @param Completion called on the default GLib main context after work is done. May be empty.
+ */
+void run(std::function<void()> work, std::function<void()> done);
+
+};
+
+#endif // WORKERPOOL_H
@@ -17,12 +17,27 @@
  * limitations under the License.
 */
 #include "logger.h"
+#include "LogRing.h"
 #include <cstdio>
 #include <cstring>
 #include <cstdarg>
+#include <cerrno>
 #include <cstdlib>
 #include <ctime>
 
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#ifndef USE_RDK_LOGGER
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include <glib.h>
+#endif
+
 #ifdef USE_RDK_LOGGER
 #include "rdk_debug.h"
 #endif
@@ -30,6 +45,39 @@
 namespace RDK
 {
 
+std::atomic<int> gLogLevel {INFO_LEVEL};
+
+static int openLocked(const std::string& path, int flags)
+{
+    int fd = open(path.c_str(), flags | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -1;
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+int openExclusiveLogFile(std::string& path, int flags)
+{
+    const std::string pid = std::to_string(getpid());
+    for (size_t pos = path.find("%p"); pos != std::string::npos; pos = path.find("%p", pos + pid.size()))
+        path.replace(pos, 2, pid);
+
+    // Every WebProcess inherits the same environment, the first one takes the plain name.
+    int fd = openLocked(path, flags);
+    if (fd < 0 && errno == EWOULDBLOCK)
+    {
+        path += "." + pid;
+        fd = openLocked(path, flags);
+    }
+    return fd;
+}
+
 static inline void sync_stdout()
 {
     if (getenv("SYNC_STDOUT"))
@@ -38,10 +86,40 @@ static inline void sync_stdout()
 
 #ifdef USE_RDK_LOGGER
 
+static const char* const kLogModule = "LOG.RDK.RDKBROWSER2";
+
+static const rdk_LogLevel kLevelMap[] =
+    {RDK_LOG_FATAL, RDK_LOG_ERROR, RDK_LOG_WARN, RDK_LOG_INFO, RDK_LOG_DEBUG, RDK_LOG_TRACE1};
+
 void logger_init()
 {
     sync_stdout();
     rdk_logger_init("/etc/debug.ini");
+
+    // Messages log4c would filter out are dropped before formatting.
+    // Most detailed level enabled for the module in debug.ini, INFO if none is.
+    const char* level = getenv("RDKBROWSER2_DEFAULT_LOG_LEVEL");
+    if (level)
+    {
+        gLogLevel = atoi(level);
+    }
+    else
+    {
+        gLogLevel = INFO_LEVEL;
+        for (int i = TRACE_LEVEL; i >= FATAL_LEVEL; --i)
+        {
+            if (rdk_dbg_enabled(kLogModule, kLevelMap[i]))
+            {
+                gLogLevel = i;
+                break;
+            }
+        }
+    }
+
+    LogRing::init();
+#ifdef ENABLE_BINARY_LOG
+    BinaryLog::init();
+#endif
 }
 
 void log(LogLevel level,
@@ -51,13 +129,12 @@ void log(LogLevel level,
     int, // thread id is already handled by rdk_logger
     const char* format, ...)
 {
-    const rdk_LogLevel levelMap[] =
-        {RDK_LOG_FATAL, RDK_LOG_ERROR, RDK_LOG_WARN, RDK_LOG_INFO, RDK_LOG_DEBUG, RDK_LOG_TRACE1};
+    if (!isLogEnabled(level))
+        return;
 
     const short kFormatMessageSize = 4096;
     const short kFinalMessageSize = 5120; //(4 + 1)KB
-    // RDKLogger is backed with log4c which has its own default level
-    // for filtering messages. Therefore, we don't check level here.
+    // log4c filters by level again, at its runtime setting.
     char userFormatted[kFormatMessageSize];
     char finalFormatted[kFinalMessageSize];
 
@@ -70,12 +147,16 @@ void log(LogLevel level,
         userFormatted);
     va_end(argptr);
 
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    LogRing::write(level, spec, func, file, line, userFormatted);
+
     // Currently, we use customized layout 'comcast_dated_nocr' in log4c.
     // This layout doesn't have trailing carriage return, so we need
     // to add it explicitly.
     // Once the default layout is used, this addition should be deleted.
-    RDK_LOG(levelMap[static_cast<int>(level)],
-      "LOG.RDK.RDKBROWSER2",
+    RDK_LOG(kLevelMap[static_cast<int>(level)],
+      kLogModule,
       "%s\n",
       finalFormatted);
 
@@ -85,40 +166,19 @@ void log(LogLevel level,
 
 #else
 
-static int gDefaultLogLevel = INFO_LEVEL;
-
-void logger_init()
-{
-    sync_stdout();
-    const char* level = getenv("RDKBROWSER2_DEFAULT_LOG_LEVEL");
-    if (level)
-        gDefaultLogLevel = static_cast<LogLevel>(atoi(level));
-}
-
-void log(LogLevel level,
+static void writeLine(LogLevel level,
+    const struct timespec& spec,
+    int threadID,
     const char* func,
     const char* file,
     int line,
-    int threadID,
-    const char* format, ...)
+    const char* message)
 {
-    if (gDefaultLogLevel < level)
-        return;
-
     const char* levelMap[] = {"Fatal", "Error", "Warning", "Info", "Verbose", "Trace"};
-    const short kFormatMessageSize = 4096;
-    char formatted[kFormatMessageSize];
-
-    va_list argptr;
-    va_start(argptr, format);
-    vsnprintf(formatted, kFormatMessageSize, format, argptr);
-    va_end(argptr);
 
     char timestamp[0xFF] = {0};
-    struct timespec spec;
     struct tm tm;
 
-    clock_gettime(CLOCK_REALTIME, &spec);
     gmtime_r(&spec.tv_sec, &tm);
     long ms = spec.tv_nsec / 1.0e6;
 
@@ -138,7 +198,7 @@ void log(LogLevel level,
             levelMap[static_cast<int>(level)],
             threadID,
             func, basename(file), line,
-            formatted);
+            message);
     }
     else
     {
@@ -146,9 +206,266 @@ void log(LogLevel level,
             timestamp,
             levelMap[static_cast<int>(level)],
             func, basename(file), line,
-            formatted);
+            message);
+    }
+}
+
+/**
+ * Asynchronous backend, enabled with RDKBROWSER2_ASYNC_LOG=1.
+ * Only the stdout write and flush move to a writer thread: logging threads
+ * still format the message (the arguments don't outlive the call, see
+ * BinaryLog for deferred formatting) into a slot of a bounded lock-free
+ * ring (multi-producer, single consumer). The writer thread writes the
+ * queued lines to stdout in batches. Slots hold as much as the synchronous
+ * path, longer messages are truncated the same way.
+ * The writer sleeps until a producer publishes a slot, then waits
+ * kFlushIntervalUs more so a burst goes out in one batch. Producers only
+ * take the wake mutex when the writer is actually asleep.
+ * When the ring is full the message is dropped and counted, the count is
+ * reported on stdout and in the LogRing.
+ */
+class AsyncLog
+{
+public:
+    static const size_t kMessageSize = 4096;
+    static const unsigned kFlushIntervalUs = 20000;
+
+    explicit AsyncLog(size_t capacity)
+        : _slots(new Slot[capacity])
+        , _mask(capacity - 1)
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    void start()
+    {
+        g_thread_unref(g_thread_new("RDKLogWriter", &AsyncLog::run, this));
+    }
+
+    void push(LogLevel level,
+        const struct timespec& spec,
+        int threadID,
+        const char* func,
+        const char* file,
+        int line,
+        const char* format,
+        va_list args)
+    {
+        size_t pos = _head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;)
+        {
+            slot = &_slots[pos & _mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                wakeWriter();
+                return;
+            }
+            else
+            {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->spec = spec;
+        slot->threadID = threadID;
+        slot->func = func;
+        slot->file = file;
+        slot->line = line;
+        vsnprintf(slot->message, kMessageSize, format, args);
+        LogRing::write(level, spec, func, file, line, slot->message);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        wakeWriter();
     }
 
+    // Writes out everything queued so far. Called by the writer thread,
+    // and by the logging thread itself before abort and at exit.
+    void drain()
+    {
+        std::lock_guard<std::mutex> lock(_drainMutex);
+
+        bool wrote = false;
+        for (;;)
+        {
+            Slot& slot = _slots[_tail & _mask];
+            if (slot.sequence.load(std::memory_order_acquire) != _tail + 1)
+                break;
+
+            writeLine(slot.level, slot.spec, slot.threadID, slot.func, slot.file, slot.line, slot.message);
+            slot.sequence.store(_tail + _mask + 1, std::memory_order_release);
+            ++_tail;
+            wrote = true;
+        }
+
+        unsigned dropped = _dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped)
+        {
+            struct timespec spec;
+            clock_gettime(CLOCK_REALTIME, &spec);
+            char message[64];
+            snprintf(message, sizeof(message), "dropped %u message(s), log ring full", dropped);
+            LogRing::write(WARNING_LEVEL, spec, __func__, __FILE__, __LINE__, message);
+            writeLine(WARNING_LEVEL, spec, 0, __func__, __FILE__, __LINE__, message);
+            wrote = true;
+        }
+
+        if (wrote)
+            fflush(stdout);
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        struct timespec spec;
+        int threadID;
+        const char* func;
+        const char* file;
+        int line;
+        char message[kMessageSize];
+    };
+
+    bool hasPending()
+    {
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        return _slots[_tail & _mask].sequence.load(std::memory_order_acquire) == _tail + 1
+            || _dropped.load(std::memory_order_relaxed);
+    }
+
+    // Pairs with the fence in waitForMessages(): either the writer sees the
+    // published slot (or drop) before sleeping, or the producer sees it asleep.
+    void wakeWriter()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_sleeping.load(std::memory_order_relaxed))
+            return;
+
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _sleeping.store(false, std::memory_order_relaxed);
+        _wakeCondition.notify_one();
+    }
+
+    void waitForMessages()
+    {
+        std::unique_lock<std::mutex> lock(_wakeMutex);
+        _sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hasPending())
+            _wakeCondition.wait(lock, [this] { return !_sleeping.load(std::memory_order_relaxed); });
+        _sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    static gpointer run(gpointer data)
+    {
+        AsyncLog* self = static_cast<AsyncLog*>(data);
+        for (;;)
+        {
+            self->waitForMessages();
+            g_usleep(kFlushIntervalUs);
+            self->drain();
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<Slot[]> _slots;
+    const size_t _mask;
+    std::atomic<size_t> _head {0};
+    size_t _tail {0}; // guarded by _drainMutex
+    std::atomic<unsigned> _dropped {0};
+    std::mutex _drainMutex;
+    std::atomic<bool> _sleeping {false};
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCondition;
+};
+
+static AsyncLog* gAsyncLog = nullptr;
+
+static void drainAsyncLog()
+{
+    gAsyncLog->drain();
+}
+
+void logger_init()
+{
+    sync_stdout();
+    gLogLevel = INFO_LEVEL;
+    const char* level = getenv("RDKBROWSER2_DEFAULT_LOG_LEVEL");
+    if (level)
+        gLogLevel = atoi(level);
+
+    LogRing::init();
+#ifdef ENABLE_BINARY_LOG
+    BinaryLog::init();
+#endif
+
+    const char* async = getenv("RDKBROWSER2_ASYNC_LOG");
+    if (async && atoi(async) == 1 && !gAsyncLog)
+    {
+        size_t capacity = 256;
+        const char* slots = getenv("RDKBROWSER2_ASYNC_LOG_SLOTS");
+        if (slots && atoi(slots) > 0)
+        {
+            size_t requested = atoi(slots);
+            for (capacity = 2; capacity < requested; capacity <<= 1);
+        }
+
+        // Never deleted, the writer thread runs until the process exits.
+        gAsyncLog = new AsyncLog(capacity);
+        gAsyncLog->start();
+        atexit(drainAsyncLog);
+    }
+}
+
+void log(LogLevel level,
+    const char* func,
+    const char* file,
+    int line,
+    int threadID,
+    const char* format, ...)
+{
+    if (!isLogEnabled(level))
+        return;
+
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+
+    va_list argptr;
+    va_start(argptr, format);
+
+    if (gAsyncLog)
+    {
+        gAsyncLog->push(level, spec, threadID, func, file, line, format, argptr);
+        va_end(argptr);
+
+        if (FATAL_LEVEL == level)
+        {
+            gAsyncLog->drain();
+            std::abort();
+        }
+        return;
+    }
+
+    const short kFormatMessageSize = 4096;
+    char formatted[kFormatMessageSize];
+
+    vsnprintf(formatted, kFormatMessageSize, format, argptr);
+    va_end(argptr);
+
+    LogRing::write(level, spec, func, file, line, formatted);
+
+    writeLine(level, spec, threadID, func, file, line, formatted);
+
     fflush(stdout);
 
     if (FATAL_LEVEL == level)
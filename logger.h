@@ -19,6 +19,17 @@
 #ifndef RDK_LOGGER_H
 #define RDK_LOGGER_H
 
+#include <atomic>
+#include <string>
+
+/**
+ * Most detailed level compiled in, calls above it are removed at build time
+ * together with their arguments. Set with -DRDK_LOG_COMPILED_LEVEL=<n>.
+ */
+#ifndef RDK_LOG_COMPILED_LEVEL
+#define RDK_LOG_COMPILED_LEVEL 5 // TRACE_LEVEL
+#endif
+
 namespace RDK
 {
 
@@ -30,12 +41,38 @@ namespace RDK
  */
 enum LogLevel {FATAL_LEVEL = 0, ERROR_LEVEL, WARNING_LEVEL, INFO_LEVEL, VERBOSE_LEVEL, TRACE_LEVEL};
 
+/**
+ * Most detailed level enabled at runtime, set by logger_init().
+ */
+extern std::atomic<int> gLogLevel;
+
+/**
+ * @brief Check whether a message of the given level would be logged
+ * Used by the logging macros before evaluating any arguments.
+ */
+inline bool isLogEnabled(LogLevel level)
+{
+    return level <= RDK_LOG_COMPILED_LEVEL
+        && level <= gLogLevel.load(std::memory_order_relaxed);
+}
+
 /**
  * @brief Init logging
  * Should be called once per program run before calling log-functions
  */
 void logger_init();
 
+/**
+ * @brief Open a log file that no other process writes to
+ * "%p" in path is replaced by the process id. The file is created if needed,
+ * not truncated, and locked with flock() for the life of the descriptor.
+ * If another process holds the lock, "<path>.<pid>" is opened instead.
+ * @param path the file to open, set to the file actually opened
+ * @param flags O_RDWR or O_WRONLY
+ * @return the descriptor, -1 on failure with errno set
+ */
+int openExclusiveLogFile(std::string& path, int flags);
+
 /**
  * @brief Log a message
  * The function is defined by logging backend.
@@ -49,11 +86,31 @@ void log(LogLevel level,
     int threadID,
     const char* format, ...);
 
-#define _LOG(LEVEL, FORMAT, ...)          \
-    RDK::log(LEVEL,                       \
-         __func__, __FILE__, __LINE__, 0, \
-         FORMAT,                          \
-         ##__VA_ARGS__)
+#ifdef ENABLE_BINARY_LOG
+#define _LOG(LEVEL, FORMAT, ...)              \
+    do {                                      \
+        if (RDK::isLogEnabled(LEVEL)) {       \
+            if (RDK::BinaryLog::isEnabled(LEVEL)) { \
+                static RDK::BinaryLog::Site _rdkLogSite(FORMAT, __FILE__, __LINE__, __func__); \
+                RDK::BinaryLog::write(_rdkLogSite, LEVEL, ##__VA_ARGS__); \
+            } else {                          \
+                RDK::log(LEVEL,               \
+                    __func__, __FILE__, __LINE__, 0, \
+                    FORMAT,                   \
+                    ##__VA_ARGS__);           \
+            }                                 \
+        }                                     \
+    } while (0)
+#else
+#define _LOG(LEVEL, FORMAT, ...)              \
+    do {                                      \
+        if (RDK::isLogEnabled(LEVEL))         \
+            RDK::log(LEVEL,                   \
+                __func__, __FILE__, __LINE__, 0, \
+                FORMAT,                       \
+                ##__VA_ARGS__);               \
+    } while (0)
+#endif
 
 #define RDKLOG_TRACE(FMT, ...)   _LOG(RDK::TRACE_LEVEL, FMT, ##__VA_ARGS__)
 #define RDKLOG_VERBOSE(FMT, ...) _LOG(RDK::VERBOSE_LEVEL, FMT, ##__VA_ARGS__)
@@ -64,4 +121,8 @@ void log(LogLevel level,
 
 } // namespace RDK
 
+#ifdef ENABLE_BINARY_LOG
+#include "BinaryLog.h"
+#endif
+
 #endif  // RDK_LOGGER_H
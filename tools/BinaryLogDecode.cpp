@@ -0,0 +1,440 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Prints a binary log written with RDKBROWSER2_BINARY_LOG as text,
+// in the same layout as the stdout logger.
+// Usage: BinaryLogDecode <file> [<file>...]
+// Pass a rotated file (<file>.1) before the current one to keep order.
+
+#include "BinaryLogFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace RDK::BinaryLogFormat;
+
+namespace
+{
+
+struct Site
+{
+    std::string format;
+    std::string file;
+    std::string func;
+    uint32_t line;
+};
+
+struct Arg
+{
+    ArgType type;
+    union
+    {
+        int64_t i;
+        uint64_t u;
+        double f;
+    };
+    std::string s;
+};
+
+struct Record
+{
+    uint64_t timestamp;
+    uint32_t tid;
+    uint32_t site;
+    uint8_t level;
+    std::vector<Arg> args;
+};
+
+class Reader
+{
+public:
+    Reader(const uint8_t* data, size_t size)
+        : _p(data), _end(data + size)
+    {
+    }
+
+    bool atEnd() const { return _p == _end; }
+
+    template <typename T>
+    bool get(T& value)
+    {
+        if (static_cast<size_t>(_end - _p) < sizeof(T))
+            return false;
+        memcpy(&value, _p, sizeof(T));
+        _p += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string& value, size_t length)
+    {
+        if (static_cast<size_t>(_end - _p) < length)
+            return false;
+        value.assign(reinterpret_cast<const char*>(_p), length);
+        _p += length;
+        return true;
+    }
+
+    bool skip(size_t length)
+    {
+        if (static_cast<size_t>(_end - _p) < length)
+            return false;
+        _p += length;
+        return true;
+    }
+
+    const uint8_t* position() const { return _p; }
+
+private:
+    const uint8_t* _p;
+    const uint8_t* _end;
+};
+
+bool readArg(Reader& reader, Arg& arg)
+{
+    uint8_t type;
+    if (!reader.get(type))
+        return false;
+
+    arg.type = static_cast<ArgType>(type);
+    switch (arg.type)
+    {
+        case SignedArg:
+            return reader.get(arg.i);
+        case UnsignedArg:
+        case PointerArg:
+            return reader.get(arg.u);
+        case DoubleArg:
+            return reader.get(arg.f);
+        case StringArg:
+        {
+            uint16_t length;
+            return reader.get(length) && reader.get(arg.s, length);
+        }
+    }
+    return false;
+}
+
+bool readEntries(Reader& reader, uint32_t tid,
+    std::unordered_map<uint32_t, Site>& sites, std::vector<Record>& records)
+{
+    while (!reader.atEnd())
+    {
+        uint8_t type;
+        if (!reader.get(type))
+            return false;
+
+        if (type == SiteEntry)
+        {
+            uint32_t id;
+            uint16_t formatLength, fileLength, funcLength;
+            Site site;
+            if (!reader.get(id) || !reader.get(site.line) || !reader.get(formatLength)
+                || !reader.get(fileLength) || !reader.get(funcLength)
+                || !reader.get(site.format, formatLength) || !reader.get(site.file, fileLength)
+                || !reader.get(site.func, funcLength))
+                return false;
+            sites[id] = site;
+        }
+        else if (type == RecordEntry)
+        {
+            Record record;
+            uint8_t argc;
+            record.tid = tid;
+            if (!reader.get(record.level) || !reader.get(argc) || !reader.get(record.site)
+                || !reader.get(record.timestamp))
+                return false;
+            record.args.resize(argc);
+            for (Arg& arg : record.args)
+            {
+                if (!readArg(reader, arg))
+                    return false;
+            }
+            records.push_back(std::move(record));
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Formats one conversion with the argument converted to what the
+// conversion expects, as printf would have read it on the device.
+std::string formatArg(std::string spec, const Arg* arg)
+{
+    char buffer[4096];
+    char conversion = spec.back();
+
+    if (!arg)
+        return "<missing>";
+
+    if (conversion == 's')
+    {
+        if (arg->type == StringArg)
+        {
+            snprintf(buffer, sizeof(buffer), spec.c_str(), arg->s.c_str());
+            return buffer;
+        }
+        spec.back() = 'd';
+        conversion = 'd';
+    }
+    else if (arg->type == StringArg)
+    {
+        return arg->s;
+    }
+
+    // Length modifier as written, e.g. "z" in "%zu".
+    size_t modifierStart = spec.find_first_of("hljztL");
+    std::string modifier = modifierStart == std::string::npos ? "" : spec.substr(modifierStart, spec.size() - 1 - modifierStart);
+    std::string base = modifierStart == std::string::npos ? spec.substr(0, spec.size() - 1) : spec.substr(0, modifierStart);
+
+    uint64_t bits = arg->type == DoubleArg ? static_cast<uint64_t>(arg->f) : arg->u;
+
+    switch (conversion)
+    {
+        case 'd':
+        case 'i':
+        {
+            int64_t value = arg->type == DoubleArg ? static_cast<int64_t>(arg->f) : static_cast<int64_t>(bits);
+            if (modifier == "hh")
+                value = static_cast<signed char>(value);
+            else if (modifier == "h")
+                value = static_cast<short>(value);
+            else if (modifier.empty())
+                value = static_cast<int>(value);
+            snprintf(buffer, sizeof(buffer), (base + "lld").c_str(), static_cast<long long>(value));
+            return buffer;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        {
+            uint64_t value = bits;
+            if (modifier == "hh")
+                value = static_cast<unsigned char>(value);
+            else if (modifier == "h")
+                value = static_cast<unsigned short>(value);
+            else if (modifier.empty())
+                value = static_cast<unsigned int>(value);
+            snprintf(buffer, sizeof(buffer), (base + "ll" + conversion).c_str(), static_cast<unsigned long long>(value));
+            return buffer;
+        }
+        case 'c':
+            snprintf(buffer, sizeof(buffer), (base + "c").c_str(), static_cast<int>(bits));
+            return buffer;
+        case 'p':
+            snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(bits));
+            return buffer;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+        {
+            double value = arg->type == DoubleArg ? arg->f
+                : arg->type == SignedArg ? static_cast<double>(arg->i) : static_cast<double>(arg->u);
+            snprintf(buffer, sizeof(buffer), (base + conversion).c_str(), value);
+            return buffer;
+        }
+    }
+    return spec;
+}
+
+std::string formatMessage(const std::string& format, const std::vector<Arg>& args)
+{
+    std::string result;
+    size_t next = 0;
+    auto nextArg = [&]() -> const Arg* {
+        return next < args.size() ? &args[next++] : nullptr;
+    };
+
+    for (size_t i = 0; i < format.size(); ++i)
+    {
+        if (format[i] != '%')
+        {
+            result += format[i];
+            continue;
+        }
+
+        if (i + 1 < format.size() && format[i + 1] == '%')
+        {
+            result += '%';
+            ++i;
+            continue;
+        }
+
+        size_t end = format.find_first_of("diouxXcspfFeEgGaAn", i + 1);
+        if (end == std::string::npos)
+        {
+            result += format.substr(i);
+            break;
+        }
+
+        std::string spec = format.substr(i, end - i + 1);
+        i = end;
+
+        // '*' width or precision is taken from the arguments.
+        size_t star;
+        while ((star = spec.find('*')) != std::string::npos)
+        {
+            const Arg* width = nextArg();
+            spec.replace(star, 1, std::to_string(width ? static_cast<int>(width->i) : 0));
+        }
+
+        if (spec.back() == 'n')
+            continue;
+
+        result += formatArg(spec, nextArg());
+    }
+    return result;
+}
+
+std::string formatTimestamp(uint64_t timestamp)
+{
+    time_t seconds = timestamp / 1000000000ull;
+    long ms = (timestamp % 1000000000ull) / 1000000;
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%02d%02d%02d-%02d:%02d:%02d.%03ld",
+        tm.tm_year % 100,
+        tm.tm_mon + 1,
+        tm.tm_mday,
+        tm.tm_hour,
+        tm.tm_min,
+        tm.tm_sec,
+        ms);
+    return buffer;
+}
+
+const char* basename(const std::string& path)
+{
+    size_t slash = path.rfind('/');
+    return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool decode(const char* path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    Reader reader(data.data(), data.size());
+    FileHeader header;
+    if (!reader.get(header) || memcmp(header.magic, kFileMagic, sizeof(header.magic)))
+    {
+        fprintf(stderr, "%s: not a binary log\n", path);
+        return false;
+    }
+    if (header.byteOrder != kByteOrderMark)
+    {
+        fprintf(stderr, "%s: written with a different byte order\n", path);
+        return false;
+    }
+    if (header.version != kVersion)
+    {
+        fprintf(stderr, "%s: unsupported version %u\n", path, header.version);
+        return false;
+    }
+
+    std::unordered_map<uint32_t, Site> sites;
+    std::vector<Record> records;
+    while (!reader.atEnd())
+    {
+        BlockHeader block;
+        if (!reader.get(block) || block.magic != kBlockMagic)
+        {
+            fprintf(stderr, "%s: truncated or corrupt block, stopping\n", path);
+            break;
+        }
+
+        const uint8_t* start = reader.position();
+        if (!reader.skip(block.size))
+        {
+            fprintf(stderr, "%s: truncated block, stopping\n", path);
+            break;
+        }
+
+        Reader entries(start, block.size);
+        if (!readEntries(entries, block.tid, sites, records))
+            fprintf(stderr, "%s: corrupt entry in block of thread %u\n", path, block.tid);
+    }
+
+    // Blocks are written per thread as their buffers fill, restore the global order.
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    const char* levelMap[] = {"Fatal", "Error", "Warning", "Info", "Verbose", "Trace"};
+    for (const Record& record : records)
+    {
+        auto site = sites.find(record.site);
+        const char* level = record.level < sizeof(levelMap) / sizeof(levelMap[0]) ? levelMap[record.level] : "?";
+        if (site == sites.end())
+        {
+            printf("%s [%s] [tid=%u] <unknown site %u>\n",
+                formatTimestamp(record.timestamp).c_str(), level, record.tid, record.site);
+            continue;
+        }
+
+        printf("%s [%s] [tid=%u] %s:%s:%u %s\n",
+            formatTimestamp(record.timestamp).c_str(),
+            level,
+            record.tid,
+            site->second.func.c_str(), basename(site->second.file), site->second.line,
+            formatMessage(site->second.format, record.args).c_str());
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <file> [<file>...]\n", argv[0]);
+        return 1;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!decode(argv[i]))
+            result = 1;
+    }
+    return result;
+}
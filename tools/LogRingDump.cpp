@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+// Prints the lines of a log ring written with RDKBROWSER2_LOG_RING,
+// oldest first, with timestamps in the layout of the stdout logger.
+// Usage: LogRingDump <file>
+
+#include "LogRingFormat.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace RDK::LogRingFormat;
+
+namespace
+{
+
+// "<seconds>.<milliseconds> rest" -> "yymmdd-HH:MM:SS.mmm rest"
+std::string formatLine(const std::string& line)
+{
+    char* end = nullptr;
+    long long seconds = strtoll(line.c_str(), &end, 10);
+    if (end == line.c_str() || *end != '.')
+        return line;
+    long ms = strtol(end + 1, &end, 10);
+
+    time_t time = seconds;
+    struct tm tm;
+    gmtime_r(&time, &tm);
+
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%02d%02d%02d-%02d:%02d:%02d.%03ld",
+        tm.tm_year % 100,
+        tm.tm_mon + 1,
+        tm.tm_mday,
+        tm.tm_hour,
+        tm.tm_min,
+        tm.tm_sec,
+        ms);
+    return timestamp + std::string(end);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream stream(argv[1], std::ios::binary);
+    if (!stream)
+    {
+        fprintf(stderr, "%s: cannot open\n", argv[1]);
+        return 1;
+    }
+    std::vector<char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    Header header;
+    if (file.size() < sizeof(header))
+    {
+        fprintf(stderr, "%s: not a log ring\n", argv[1]);
+        return 1;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, kMagic, sizeof(header.magic)))
+    {
+        fprintf(stderr, "%s: not a log ring\n", argv[1]);
+        return 1;
+    }
+    if (header.byteOrder != kByteOrderMark)
+    {
+        fprintf(stderr, "%s: written with a different byte order\n", argv[1]);
+        return 1;
+    }
+    if (header.headerSize < sizeof(header) || file.size() < header.headerSize + header.capacity)
+    {
+        fprintf(stderr, "%s: truncated, expected %" PRIu64 " bytes of data\n", argv[1], header.capacity);
+        return 1;
+    }
+
+    const char* data = file.data() + header.headerSize;
+    uint64_t capacity = header.capacity;
+    uint64_t cursor = header.cursor;
+
+    // Unwrap into write order. After a wrap the oldest line is cut, drop it.
+    std::string text;
+    if (cursor <= capacity)
+    {
+        text.assign(data, cursor);
+    }
+    else
+    {
+        uint64_t start = cursor % capacity;
+        text.assign(data + start, capacity - start);
+        text.append(data, start);
+        size_t newline = text.find('\n');
+        text.erase(0, newline == std::string::npos ? text.size() : newline + 1);
+    }
+
+    size_t begin = 0;
+    while (begin < text.size())
+    {
+        size_t newline = text.find('\n', begin);
+        if (newline == std::string::npos)
+            newline = text.size();
+        printf("%s\n", formatLine(text.substr(begin, newline - begin)).c_str());
+        begin = newline + 1;
+    }
+
+    if (cursor > capacity)
+        fprintf(stderr, "%s: %" PRIu64 " bytes overwritten before the oldest line\n", argv[1], cursor - capacity);
+    return 0;
+}
@@ -19,8 +19,11 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <JavaScriptCore/JSObjectRef.h>
 #include <JavaScriptCore/JSRetainPtr.h>
+#include <WebKit/WKBase.h>
 #include <WebKit/WKString.h>
+#include <cstdio>
 #include <memory>
 #include <string>
 #include <fstream>
@@ -41,6 +44,21 @@ static inline std::string toStdString(WKStringRef string)
     return len ? std::string(buffer.get(), len - 1) : "";
 }
 
+/**
+ * Converts JSStringRef to std::string
+ */
+static inline std::string toStdString(JSStringRef string)
+{
+    if (!string)
+        return "";
+
+    size_t size = JSStringGetMaximumUTF8CStringSize(string);
+    auto buffer = std::make_unique<char[]>(size);
+    size_t len = JSStringGetUTF8CString(string, buffer.get(), size);
+
+    return len ? std::string(buffer.get(), len - 1) : "";
+}
+
 /**
  * Reads content of the file.
  * @return true If success.
@@ -67,7 +85,120 @@ static inline JSValueRef evaluateUserScript(JSContextRef context, const std::str
     return JSEvaluateScript(context, str.get(), nullptr, nullptr, 0, exc);
 }
 
-std::string GetURL();
+/**
+ * Evaluates already created script string in specific JavaScript context.
+ * @return Result from JavaScript.
+ */
+static inline JSValueRef evaluateUserScript(JSContextRef context, JSStringRef script, JSValueRef* exc)
+{
+    return JSEvaluateScript(context, script, nullptr, nullptr, 0, exc);
+}
+
+/**
+ * Creates an error of a standard type ("TypeError", "SyntaxError", ...) with the
+ * constructor found on the global object, or a plain Error if there is none.
+ */
+static inline JSObjectRef makeError(JSContextRef context, const char* type, JSStringRef message)
+{
+    JSValueRef argument = JSValueMakeString(context, message);
+    JSRetainPtr<JSStringRef> name = adopt(JSStringCreateWithUTF8CString(type));
+    JSValueRef constructor = JSObjectGetProperty(context, JSContextGetGlobalObject(context), name.get(), nullptr);
+    if (constructor && JSValueIsObject(context, constructor))
+    {
+        JSObjectRef object = JSValueToObject(context, constructor, nullptr);
+        if (object && JSObjectIsConstructor(context, object))
+        {
+            JSValueRef exception = nullptr;
+            JSObjectRef error = JSObjectCallAsConstructor(context, object, 1, &argument, &exception);
+            if (error && !exception)
+                return error;
+        }
+    }
+    return JSObjectMakeError(context, 1, &argument, nullptr);
+}
+
+/**
+ * Defines a configurable accessor property 'name' on the global object whose
+ * getter is 'getter', with Object.defineProperty. Must be called before any
+ * page script runs, so that Object is still the built-in one.
+ * @return false if the property could not be defined.
+ */
+static inline bool defineLazyGetter(JSContextRef context, const char* name, JSObjectRef getter)
+{
+    JSObjectRef windowObject = JSContextGetGlobalObject(context);
+    JSValueRef exc = nullptr;
+
+    JSRetainPtr<JSStringRef> objectStr = adopt(JSStringCreateWithUTF8CString("Object"));
+    JSValueRef objectCtor = JSObjectGetProperty(context, windowObject, objectStr.get(), &exc);
+    if (exc || !objectCtor || !JSValueIsObject(context, objectCtor))
+        return false;
+
+    JSRetainPtr<JSStringRef> definePropertyStr = adopt(JSStringCreateWithUTF8CString("defineProperty"));
+    JSValueRef defineProperty = JSObjectGetProperty(context, (JSObjectRef) objectCtor, definePropertyStr.get(), &exc);
+    if (exc || !defineProperty || !JSValueIsObject(context, defineProperty))
+        return false;
+
+    JSRetainPtr<JSStringRef> getStr = adopt(JSStringCreateWithUTF8CString("get"));
+    JSRetainPtr<JSStringRef> configurableStr = adopt(JSStringCreateWithUTF8CString("configurable"));
+    JSObjectRef descriptor = JSObjectMake(context, nullptr, nullptr);
+    JSObjectSetProperty(context, descriptor, getStr.get(), getter, kJSPropertyAttributeNone, nullptr);
+    JSObjectSetProperty(context, descriptor, configurableStr.get(),
+        JSValueMakeBoolean(context, true), kJSPropertyAttributeNone, nullptr);
+
+    JSRetainPtr<JSStringRef> nameStr = adopt(JSStringCreateWithUTF8CString(name));
+    JSValueRef argv[] = { windowObject, JSValueMakeString(context, nameStr.get()), descriptor };
+    (void) JSObjectCallAsFunction(context, (JSObjectRef) defineProperty, (JSObjectRef) objectCtor,
+        sizeof(argv)/sizeof(argv[0]), argv, &exc);
+    return !exc;
+}
+
+/**
+ * Appends str to out as a quoted JSON string.
+ */
+static inline void appendJSONString(std::string& out, const std::string& str)
+{
+    out += '"';
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Main frame URL of a page, shared read-only between the page state and its users.
+ */
+typedef std::shared_ptr<const std::string> SharedURL;
+
+/**
+ * Returns the URL of the page owning the context, null if unknown.
+ */
+SharedURL GetURL(JSContextRef context);
+
+/**
+ * Returns the main frame URL of the page as of its last commit, null if unknown.
+ */
+SharedURL GetURL(WKBundlePageRef page);
 
 } // namespace Utils
 